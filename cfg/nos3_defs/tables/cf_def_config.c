@@ -27,12 +27,12 @@
 
 CF_ConfigTable_t CF_config_table = {
     10,    /* ticks_per_second */
-    16384, /* max number of bytes per wakeup to calculate r2 recv file crc */
+    262144, /* max number of bytes per wakeup to calculate r2 recv file crc, 2.5 MB/s at 10 Hz */
     24,    /* local entity id */
     {      /* channel configuration for CF_NUM_CHANNELS */
      {
          /* channel 0 */
-         5,      /* max number of outgoing messages per wakeup */
+         16,     /* max number of outgoing messages per wakeup, half the TO CF_PDU_TLM_MID depth */
          5,      /* max number of rx messages per wakeup */
          3,      /* ack timer */
          3,      /* nak timer */
@@ -78,7 +78,7 @@ CF_ConfigTable_t CF_config_table = {
          "", /* throttle sem, empty string means no throttle */
          1   /* dequeue enable flag (1 = enabled) */
      }},
-    200,       /* outgoing_file_chunk_size */
+    480,       /* outgoing_file_chunk_size, fills a CF_MAX_PDU_SIZE (512) PDU after headers */
     "/cf/tmp", /* temporary file directory */
 };
 CFE_TBL_FILEDEF(CF_config_table, CF.config_table, CF config table, cf_def_config.tbl)
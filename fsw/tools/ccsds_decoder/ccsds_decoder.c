@@ -0,0 +1,985 @@
+/************************************************************************
+** File: ccsds_decoder.c
+**
+** Purpose:
+**  Host tool that turns raw CCSDS telemetry archives into per APID
+**  columnar data for post-pass processing.
+**
+** Notes:
+**  1. Archives are memory mapped and scanned once to find every packet,
+**     either as back to back space packets or inside fixed length TM
+**     transfer frames.  Archives are split in parallel, one per thread,
+**     and their packets are merged per APID in command line order.  Each
+**     archive is scanned by a single thread, since a space packet stream
+**     has no sync marker to restart from and frame reassembly carries per
+**     VC state from frame to frame.  Packets are then decoded per APID in
+**     parallel.
+**  2. Each APID gets a directory holding its raw packet stream, one
+**     column file per dictionary field, a time column and a time index.
+**     Columns are arrays of native endian uint64, int64 or double values.
+**  3. The packet dictionary is generated from the ground system telemetry
+**     definitions by scripts/gsw/tlm_dict_gen.py.
+**
+*************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define CCSDS_DECODER_MAX_APIDS      2048
+#define CCSDS_DECODER_IDLE_APID      0x7FF
+#define CCSDS_DECODER_PRI_HDR_LEN    6
+#define CCSDS_DECODER_TLM_HDR_LEN    12    /* Primary header plus cFE 32/16 time */
+#define CCSDS_DECODER_TF_HDR_LEN     6
+#define CCSDS_DECODER_TF_OCF_LEN     4
+#define CCSDS_DECODER_TF_FECF_LEN    2
+#define CCSDS_DECODER_TF_ASM_LEN     4
+#define CCSDS_DECODER_TF_MAX_VC      8
+#define CCSDS_DECODER_FHP_NONE       0x7FF
+#define CCSDS_DECODER_FHP_IDLE       0x7FE
+#define CCSDS_DECODER_INDEX_STRIDE   256   /* Rows per time index entry */
+#define CCSDS_DECODER_CHUNK_ROWS     4096  /* Rows decoded before columns are written */
+#define CCSDS_DECODER_NAME_LEN       64
+#define CCSDS_DECODER_PATH_LEN       1024
+#define CCSDS_DECODER_MAX_THREADS    64
+
+/* Short unsigned names, matching the cFE common types */
+typedef uint8_t  uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef uint64_t uint64;
+
+typedef enum
+{
+    FIELD_UINT,
+    FIELD_INT,
+    FIELD_FLOAT
+} FieldType_t;
+
+typedef struct
+{
+    char        Name[CCSDS_DECODER_NAME_LEN];
+    uint32      BitOffset;
+    uint32      Bits;
+    FieldType_t Type;
+    int         LittleEndian;
+} Field_t;
+
+typedef struct
+{
+    char     Name[CCSDS_DECODER_NAME_LEN];
+    Field_t *Fields;
+    uint32   FieldCount;
+    uint32   FieldCap;
+} PacketDef_t;
+
+typedef struct
+{
+    uint32  Source;
+    uint32  Length;
+    uint64  Offset;
+} PacketRef_t;
+
+typedef struct
+{
+    PacketRef_t *Refs;
+    uint64       Count;
+    uint64       Cap;
+    uint64       ShortPackets;
+    double       FirstTime;
+    double       LastTime;
+} Stream_t;
+
+typedef struct
+{
+    const uint8 *Data;
+    uint64       Size;
+    uint8       *Owned;    /* Reassembled packets from transfer frames */
+    Stream_t    *Streams;  /* Packets found in this source, per APID */
+    uint64       BadHeaders;
+    uint64       BadFrames;
+    uint64       FrameGaps;
+} Source_t;
+
+typedef struct
+{
+    uint8  *Buf;
+    uint64  Len;
+    uint64  Cap;
+    int     InSync;
+    int     LastCount;
+} VcState_t;
+
+typedef struct
+{
+    PacketDef_t    *Dict[CCSDS_DECODER_MAX_APIDS];
+    Stream_t        Streams[CCSDS_DECODER_MAX_APIDS];
+    Source_t       *Sources;
+    uint32          SourceCount;
+    const char     *OutDir;
+    double          EpochOffset;
+    int             Frames;
+    uint32          FrameLen;
+    int             HasAsm;
+    int             HasFecf;
+    uint32          NextSource;
+    uint32          NextApid;
+    pthread_mutex_t Lock;
+    uint64          BadHeaders;
+    uint64          BadFrames;
+    uint64          FrameGaps;
+} Decoder_t;
+
+static Decoder_t Decoder;
+
+/************************************************************************
+** Utility functions
+*************************************************************************/
+
+static void *CheckedRealloc(void *Ptr, size_t Size)
+{
+    void *NewPtr = realloc(Ptr, Size);
+    if (NewPtr == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    return NewPtr;
+}
+
+static double NowSeconds(void)
+{
+    struct timeval Tv;
+    gettimeofday(&Tv, NULL);
+    return (double)Tv.tv_sec + (double)Tv.tv_usec / 1e6;
+}
+
+static uint16 CrcTable[256];
+
+static void Crc16Init(void)
+{
+    uint32 i;
+    int    b;
+
+    for (i = 0; i < 256; i++)
+    {
+        uint16 Crc = (uint16)(i << 8);
+        for (b = 0; b < 8; b++)
+        {
+            Crc = (Crc & 0x8000) ? (uint16)((Crc << 1) ^ 0x1021) : (uint16)(Crc << 1);
+        }
+        CrcTable[i] = Crc;
+    }
+}
+
+/* CRC-16-CCITT as used for the transfer frame error control field */
+static uint16 Crc16Ccitt(const uint8 *Data, uint64 Len)
+{
+    uint16 Crc = 0xFFFF;
+    uint64 i;
+
+    for (i = 0; i < Len; i++)
+    {
+        Crc = (uint16)((Crc << 8) ^ CrcTable[((Crc >> 8) ^ Data[i]) & 0xFF]);
+    }
+    return Crc;
+}
+
+static uint64 ExtractBits(const uint8 *Pkt, uint32 BitOffset, uint32 Bits, int LittleEndian)
+{
+    uint64 Value = 0;
+    uint32 i;
+
+    if ((BitOffset % 8) == 0 && (Bits % 8) == 0)
+    {
+        const uint8 *p = &Pkt[BitOffset / 8];
+        if (LittleEndian)
+        {
+            for (i = Bits / 8; i > 0; i--)
+            {
+                Value = (Value << 8) | p[i - 1];
+            }
+        }
+        else
+        {
+            for (i = 0; i < Bits / 8; i++)
+            {
+                Value = (Value << 8) | p[i];
+            }
+        }
+    }
+    else
+    {
+        for (i = 0; i < Bits; i++)
+        {
+            uint32 b = BitOffset + i;
+            Value = (Value << 1) | ((Pkt[b >> 3] >> (7 - (b & 7))) & 1u);
+        }
+    }
+    return Value;
+}
+
+static double PacketTime(const uint8 *Pkt, uint32 Len)
+{
+    uint32 Secs;
+    uint16 Subs;
+
+    if (Len < CCSDS_DECODER_TLM_HDR_LEN)
+    {
+        return 0.0;
+    }
+    Secs = ((uint32)Pkt[6] << 24) | ((uint32)Pkt[7] << 16) | ((uint32)Pkt[8] << 8) | Pkt[9];
+    Subs = (uint16)((Pkt[10] << 8) | Pkt[11]);
+    return (double)Secs + (double)Subs / 65536.0 + Decoder.EpochOffset;
+}
+
+/************************************************************************
+** Dictionary
+**
+** PACKET <apid> <name>
+** FIELD  <name> <bit offset> <bits> <UINT|INT|FLOAT> <BIG|LITTLE>
+*************************************************************************/
+
+static int LoadDictionary(const char *Path)
+{
+    FILE        *Fp;
+    char         Line[512];
+    PacketDef_t *Current = NULL;
+    uint32       LineNum = 0;
+
+    Fp = fopen(Path, "r");
+    if (Fp == NULL)
+    {
+        fprintf(stderr, "Unable to open dictionary %s: %s\n", Path, strerror(errno));
+        return -1;
+    }
+
+    while (fgets(Line, sizeof(Line), Fp) != NULL)
+    {
+        char         Kind[16], Name[CCSDS_DECODER_NAME_LEN], Type[16], Endian[16];
+        unsigned int Offset, Bits;
+        int          Apid;
+
+        LineNum++;
+        if (Line[0] == '#' || Line[0] == '\n')
+        {
+            continue;
+        }
+        if (sscanf(Line, "%15s", Kind) != 1)
+        {
+            continue;
+        }
+
+        if (strcmp(Kind, "PACKET") == 0 && sscanf(Line, "%*s %i %63s", &Apid, Name) == 2)
+        {
+            Apid &= (CCSDS_DECODER_MAX_APIDS - 1);
+            if (Decoder.Dict[Apid] == NULL)
+            {
+                Decoder.Dict[Apid] = CheckedRealloc(NULL, sizeof(PacketDef_t));
+                memset(Decoder.Dict[Apid], 0, sizeof(PacketDef_t));
+            }
+            Current = Decoder.Dict[Apid];
+            Current->FieldCount = 0;
+            snprintf(Current->Name, sizeof(Current->Name), "%s", Name);
+        }
+        else if (strcmp(Kind, "FIELD") == 0 && Current != NULL &&
+                 sscanf(Line, "%*s %63s %u %u %15s %15s", Name, &Offset, &Bits, Type, Endian) == 5)
+        {
+            Field_t *F;
+
+            if (Bits == 0 || Bits > 64 || (strcmp(Type, "FLOAT") == 0 && Bits != 32 && Bits != 64))
+            {
+                fprintf(stderr, "%s:%u: unsupported field size, skipped\n", Path, LineNum);
+                continue;
+            }
+            if (Current->FieldCount == Current->FieldCap)
+            {
+                Current->FieldCap = Current->FieldCap ? Current->FieldCap * 2 : 16;
+                Current->Fields   = CheckedRealloc(Current->Fields, Current->FieldCap * sizeof(Field_t));
+            }
+            F = &Current->Fields[Current->FieldCount++];
+            memset(F, 0, sizeof(*F));
+            snprintf(F->Name, sizeof(F->Name), "%s", Name);
+            F->BitOffset    = Offset;
+            F->Bits         = Bits;
+            F->Type         = (strcmp(Type, "FLOAT") == 0) ? FIELD_FLOAT : (strcmp(Type, "INT") == 0) ? FIELD_INT : FIELD_UINT;
+            F->LittleEndian = (strcmp(Endian, "LITTLE") == 0);
+        }
+        else
+        {
+            fprintf(stderr, "%s:%u: unrecognized line, skipped\n", Path, LineNum);
+        }
+    }
+
+    fclose(Fp);
+    return 0;
+}
+
+/************************************************************************
+** Packet splitting
+*************************************************************************/
+
+static void AddPacket(uint32 Source, uint64 Offset, uint32 Length)
+{
+    const uint8 *Pkt  = Decoder.Sources[Source].Data + Offset;
+    uint16       Apid = (uint16)(((Pkt[0] << 8) | Pkt[1]) & 0x7FF);
+    Stream_t    *S    = &Decoder.Sources[Source].Streams[Apid];
+    double       Time;
+
+    if (Apid == CCSDS_DECODER_IDLE_APID)
+    {
+        return;
+    }
+    if (S->Count == S->Cap)
+    {
+        S->Cap  = S->Cap ? S->Cap * 2 : 1024;
+        S->Refs = CheckedRealloc(S->Refs, S->Cap * sizeof(PacketRef_t));
+    }
+    S->Refs[S->Count].Source = Source;
+    S->Refs[S->Count].Offset = Offset;
+    S->Refs[S->Count].Length = Length;
+
+    Time = PacketTime(Pkt, Length);
+    if (S->Count == 0)
+    {
+        S->FirstTime = Time;
+    }
+    S->LastTime = Time;
+    S->Count++;
+}
+
+static void SplitPackets(uint32 Source)
+{
+    const uint8 *Data = Decoder.Sources[Source].Data;
+    uint64       Size = Decoder.Sources[Source].Size;
+    uint64       Pos  = 0;
+
+    while (Pos + CCSDS_DECODER_PRI_HDR_LEN <= Size)
+    {
+        uint32 Len = (uint32)((Data[Pos + 4] << 8) | Data[Pos + 5]) + 7;
+
+        /* Version must be zero, otherwise step a byte at a time to resync */
+        if ((Data[Pos] & 0xE0) != 0)
+        {
+            Decoder.Sources[Source].BadHeaders++;
+            Pos++;
+            continue;
+        }
+        if (Pos + Len > Size)
+        {
+            Decoder.Sources[Source].BadHeaders++;
+            break;
+        }
+        AddPacket(Source, Pos, Len);
+        Pos += Len;
+    }
+}
+
+static void VcAppend(VcState_t *Vc, const uint8 *Data, uint64 Len)
+{
+    if (Vc->Len + Len > Vc->Cap)
+    {
+        Vc->Cap = (Vc->Len + Len) * 2;
+        Vc->Buf = CheckedRealloc(Vc->Buf, Vc->Cap);
+    }
+    memcpy(Vc->Buf + Vc->Len, Data, Len);
+    Vc->Len += Len;
+}
+
+/* Move every complete packet at the front of the VC buffer to the output */
+static void VcDrain(VcState_t *Vc, uint8 **Out, uint64 *OutLen, uint64 *OutCap)
+{
+    uint64 Pos = 0;
+
+    while (Vc->Len - Pos >= CCSDS_DECODER_PRI_HDR_LEN)
+    {
+        uint32 Len = (uint32)((Vc->Buf[Pos + 4] << 8) | Vc->Buf[Pos + 5]) + 7;
+        if (Vc->Len - Pos < Len)
+        {
+            break;
+        }
+        if (*OutLen + Len > *OutCap)
+        {
+            *OutCap = (*OutLen + Len) * 2;
+            *Out    = CheckedRealloc(*Out, *OutCap);
+        }
+        memcpy(*Out + *OutLen, Vc->Buf + Pos, Len);
+        *OutLen += Len;
+        Pos += Len;
+    }
+    if (Pos > 0)
+    {
+        memmove(Vc->Buf, Vc->Buf + Pos, Vc->Len - Pos);
+        Vc->Len -= Pos;
+    }
+}
+
+/*
+** Reassemble the packets carried in fixed length transfer frames into a
+** contiguous buffer, which then becomes the source that is split by APID
+*/
+static void ExtractFrames(uint32 Source, uint32 FrameLen, int HasAsm, int HasFecf)
+{
+    const uint8 *Data   = Decoder.Sources[Source].Data;
+    uint64       Size   = Decoder.Sources[Source].Size;
+    uint32       Stride = FrameLen + (HasAsm ? CCSDS_DECODER_TF_ASM_LEN : 0);
+    VcState_t    Vc[CCSDS_DECODER_TF_MAX_VC];
+    uint8       *Out    = NULL;
+    uint64       OutLen = 0;
+    uint64       OutCap = 0;
+    uint64       Pos;
+    int          i;
+
+    memset(Vc, 0, sizeof(Vc));
+    for (i = 0; i < CCSDS_DECODER_TF_MAX_VC; i++)
+    {
+        Vc[i].LastCount = -1;
+    }
+
+    for (Pos = 0; Pos + Stride <= Size; Pos += Stride)
+    {
+        const uint8 *Frame   = Data + Pos + (HasAsm ? CCSDS_DECODER_TF_ASM_LEN : 0);
+        uint32       VcId    = (Frame[1] >> 1) & 0x7;
+        int          HasOcf  = Frame[1] & 0x1;
+        uint32       VcCount = Frame[3];
+        uint32       Fhp     = (uint32)(((Frame[4] << 8) | Frame[5]) & 0x7FF);
+        uint32       DataLen = FrameLen - CCSDS_DECODER_TF_HDR_LEN - (HasOcf ? CCSDS_DECODER_TF_OCF_LEN : 0) -
+                         (HasFecf ? CCSDS_DECODER_TF_FECF_LEN : 0);
+        const uint8 *Field   = Frame + CCSDS_DECODER_TF_HDR_LEN;
+        VcState_t   *V       = &Vc[VcId];
+
+        if (HasFecf && Crc16Ccitt(Frame, FrameLen - 2) != (uint16)((Frame[FrameLen - 2] << 8) | Frame[FrameLen - 1]))
+        {
+            Decoder.Sources[Source].BadFrames++;
+            V->InSync = 0;
+            V->Len    = 0;
+            continue;
+        }
+        if (V->LastCount >= 0 && VcCount != (uint32)((V->LastCount + 1) & 0xFF))
+        {
+            Decoder.Sources[Source].FrameGaps++;
+            V->InSync = 0;
+            V->Len    = 0;
+        }
+        V->LastCount = (int)VcCount;
+
+        if (Fhp == CCSDS_DECODER_FHP_IDLE)
+        {
+            continue;
+        }
+        if (!V->InSync)
+        {
+            /* Drop the tail of a packet whose start was lost */
+            if (Fhp == CCSDS_DECODER_FHP_NONE || Fhp >= DataLen)
+            {
+                continue;
+            }
+            Field += Fhp;
+            DataLen -= Fhp;
+            V->InSync = 1;
+        }
+        VcAppend(V, Field, DataLen);
+        VcDrain(V, &Out, &OutLen, &OutCap);
+    }
+
+    for (i = 0; i < CCSDS_DECODER_TF_MAX_VC; i++)
+    {
+        free(Vc[i].Buf);
+    }
+
+    Decoder.Sources[Source].Owned = Out;
+    Decoder.Sources[Source].Data  = Out;
+    Decoder.Sources[Source].Size  = OutLen;
+}
+
+static void SplitSource(uint32 Source)
+{
+    Source_t *Src = &Decoder.Sources[Source];
+
+    if (Src->Data == NULL)
+    {
+        return;
+    }
+    Src->Streams = CheckedRealloc(NULL, CCSDS_DECODER_MAX_APIDS * sizeof(Stream_t));
+    memset(Src->Streams, 0, CCSDS_DECODER_MAX_APIDS * sizeof(Stream_t));
+
+    if (Decoder.Frames)
+    {
+        void  *Map     = (void *)Src->Data;
+        uint64 MapSize = Src->Size;
+
+        ExtractFrames(Source, Decoder.FrameLen, Decoder.HasAsm, Decoder.HasFecf);
+        munmap(Map, (size_t)MapSize);
+    }
+    SplitPackets(Source);
+}
+
+static void *SplitWorker(void *Arg)
+{
+    (void)Arg;
+    for (;;)
+    {
+        uint32 Source;
+
+        pthread_mutex_lock(&Decoder.Lock);
+        Source = Decoder.NextSource++;
+        pthread_mutex_unlock(&Decoder.Lock);
+
+        if (Source >= Decoder.SourceCount)
+        {
+            break;
+        }
+        SplitSource(Source);
+    }
+    return NULL;
+}
+
+/* Append each source's packets to the APID streams, in command line order */
+static void MergeSources(void)
+{
+    uint32 s, Apid;
+
+    for (s = 0; s < Decoder.SourceCount; s++)
+    {
+        Source_t *Src = &Decoder.Sources[s];
+
+        if (Src->Streams == NULL)
+        {
+            continue;
+        }
+        for (Apid = 0; Apid < CCSDS_DECODER_MAX_APIDS; Apid++)
+        {
+            Stream_t *From = &Src->Streams[Apid];
+            Stream_t *To   = &Decoder.Streams[Apid];
+
+            if (From->Count == 0)
+            {
+                continue;
+            }
+            if (To->Count == 0)
+            {
+                *To = *From;
+                continue;
+            }
+            if (To->Count + From->Count > To->Cap)
+            {
+                To->Cap  = To->Count + From->Count;
+                To->Refs = CheckedRealloc(To->Refs, To->Cap * sizeof(PacketRef_t));
+            }
+            memcpy(To->Refs + To->Count, From->Refs, From->Count * sizeof(PacketRef_t));
+            To->Count += From->Count;
+            To->LastTime = From->LastTime;
+            free(From->Refs);
+        }
+        Decoder.BadHeaders += Src->BadHeaders;
+        Decoder.BadFrames += Src->BadFrames;
+        Decoder.FrameGaps += Src->FrameGaps;
+        free(Src->Streams);
+        Src->Streams = NULL;
+    }
+}
+
+/************************************************************************
+** Per APID decoding
+*************************************************************************/
+
+static FILE *OpenOutput(const char *Dir, const char *Name)
+{
+    char  Path[CCSDS_DECODER_PATH_LEN];
+    FILE *Fp;
+
+    snprintf(Path, sizeof(Path), "%s/%s", Dir, Name);
+    Fp = fopen(Path, "wb");
+    if (Fp == NULL)
+    {
+        fprintf(stderr, "Unable to create %s: %s\n", Path, strerror(errno));
+        return NULL;
+    }
+    setvbuf(Fp, NULL, _IOFBF, 1 << 20);
+    return Fp;
+}
+
+static void DecodeApid(uint32 Apid)
+{
+    Stream_t          *S   = &Decoder.Streams[Apid];
+    const PacketDef_t *Def = Decoder.Dict[Apid];
+    uint32             NumFields = (Def != NULL) ? Def->FieldCount : 0;
+    char               Dir[CCSDS_DECODER_PATH_LEN];
+    FILE              *RawFp, *TimeFp, *IndexFp, *SchemaFp;
+    FILE             **ColFp;
+    uint64            *Cols;
+    double            *Times;
+    uint64             Row, Chunk;
+    uint32             f;
+
+    if (Def != NULL)
+    {
+        snprintf(Dir, sizeof(Dir), "%s/%s_%03x", Decoder.OutDir, Def->Name, (unsigned int)Apid);
+    }
+    else
+    {
+        snprintf(Dir, sizeof(Dir), "%s/apid_%03x", Decoder.OutDir, (unsigned int)Apid);
+    }
+    if (mkdir(Dir, 0755) != 0 && errno != EEXIST)
+    {
+        fprintf(stderr, "Unable to create %s: %s\n", Dir, strerror(errno));
+        return;
+    }
+
+    RawFp    = OpenOutput(Dir, "packets.ccsds");
+    TimeFp   = OpenOutput(Dir, "time.col");
+    IndexFp  = OpenOutput(Dir, "time.idx");
+    SchemaFp = OpenOutput(Dir, "columns.txt");
+    ColFp    = CheckedRealloc(NULL, (NumFields + 1) * sizeof(FILE *));
+    Cols     = CheckedRealloc(NULL, ((size_t)NumFields + 1) * CCSDS_DECODER_CHUNK_ROWS * sizeof(uint64));
+    Times    = CheckedRealloc(NULL, CCSDS_DECODER_CHUNK_ROWS * sizeof(double));
+    if (RawFp == NULL || TimeFp == NULL || IndexFp == NULL || SchemaFp == NULL)
+    {
+        NumFields = 0;
+    }
+
+    if (SchemaFp != NULL)
+    {
+        fprintf(SchemaFp, "time double\n");
+    }
+    for (f = 0; f < NumFields; f++)
+    {
+        char ColName[CCSDS_DECODER_NAME_LEN + 8];
+        snprintf(ColName, sizeof(ColName), "%s.col", Def->Fields[f].Name);
+        ColFp[f] = OpenOutput(Dir, ColName);
+        fprintf(SchemaFp, "%s %s\n", Def->Fields[f].Name,
+                Def->Fields[f].Type == FIELD_FLOAT ? "double" : Def->Fields[f].Type == FIELD_INT ? "int64" : "uint64");
+    }
+
+    for (Row = 0; Row < S->Count && RawFp != NULL && TimeFp != NULL && IndexFp != NULL; Row += Chunk)
+    {
+        uint64 r;
+
+        Chunk = S->Count - Row;
+        if (Chunk > CCSDS_DECODER_CHUNK_ROWS)
+        {
+            Chunk = CCSDS_DECODER_CHUNK_ROWS;
+        }
+
+        for (r = 0; r < Chunk; r++)
+        {
+            const PacketRef_t *Ref = &S->Refs[Row + r];
+            const uint8       *Pkt = Decoder.Sources[Ref->Source].Data + Ref->Offset;
+
+            fwrite(Pkt, 1, Ref->Length, RawFp);
+            Times[r] = PacketTime(Pkt, Ref->Length);
+
+            for (f = 0; f < NumFields; f++)
+            {
+                const Field_t *F     = &Def->Fields[f];
+                uint64         Value = 0;
+                double         Real;
+
+                if ((uint64)F->BitOffset + F->Bits > (uint64)Ref->Length * 8)
+                {
+                    S->ShortPackets += (f == 0);
+                    Real = 0.0;
+                    memcpy(&Value, &Real, sizeof(Value));
+                }
+                else
+                {
+                    Value = ExtractBits(Pkt, F->BitOffset, F->Bits, F->LittleEndian);
+                    if (F->Type == FIELD_FLOAT)
+                    {
+                        if (F->Bits == 32)
+                        {
+                            uint32 Raw32 = (uint32)Value;
+                            float  Single;
+                            memcpy(&Single, &Raw32, sizeof(Single));
+                            Real = (double)Single;
+                        }
+                        else
+                        {
+                            memcpy(&Real, &Value, sizeof(Real));
+                        }
+                        memcpy(&Value, &Real, sizeof(Value));
+                    }
+                    else if (F->Type == FIELD_INT && F->Bits < 64 && (Value >> (F->Bits - 1)) & 1u)
+                    {
+                        Value |= ~(uint64)0 << F->Bits;
+                    }
+                }
+                Cols[(size_t)f * CCSDS_DECODER_CHUNK_ROWS + r] = Value;
+            }
+        }
+
+        fwrite(Times, sizeof(double), Chunk, TimeFp);
+        for (f = 0; f < NumFields; f++)
+        {
+            if (ColFp[f] != NULL)
+            {
+                fwrite(&Cols[(size_t)f * CCSDS_DECODER_CHUNK_ROWS], sizeof(uint64), Chunk, ColFp[f]);
+            }
+        }
+
+        /*
+        ** Index entries hold the time span of each block of rows so a time
+        ** range can be located without reading the time column, even when
+        ** packets were archived out of order
+        */
+        for (r = 0; r < Chunk; r += CCSDS_DECODER_INDEX_STRIDE)
+        {
+            uint64 End = (r + CCSDS_DECODER_INDEX_STRIDE < Chunk) ? r + CCSDS_DECODER_INDEX_STRIDE : Chunk;
+            double Entry[2];
+            uint64 First = Row + r;
+            uint64 i;
+
+            Entry[0] = Entry[1] = Times[r];
+            for (i = r + 1; i < End; i++)
+            {
+                Entry[0] = (Times[i] < Entry[0]) ? Times[i] : Entry[0];
+                Entry[1] = (Times[i] > Entry[1]) ? Times[i] : Entry[1];
+            }
+            fwrite(Entry, sizeof(double), 2, IndexFp);
+            fwrite(&First, sizeof(First), 1, IndexFp);
+        }
+    }
+
+    for (f = 0; f < NumFields; f++)
+    {
+        if (ColFp[f] != NULL)
+        {
+            fclose(ColFp[f]);
+        }
+    }
+    if (RawFp != NULL)    fclose(RawFp);
+    if (TimeFp != NULL)   fclose(TimeFp);
+    if (IndexFp != NULL)  fclose(IndexFp);
+    if (SchemaFp != NULL) fclose(SchemaFp);
+    free(ColFp);
+    free(Cols);
+    free(Times);
+}
+
+static void *DecodeWorker(void *Arg)
+{
+    (void)Arg;
+    for (;;)
+    {
+        uint32 Apid;
+
+        pthread_mutex_lock(&Decoder.Lock);
+        while (Decoder.NextApid < CCSDS_DECODER_MAX_APIDS && Decoder.Streams[Decoder.NextApid].Count == 0)
+        {
+            Decoder.NextApid++;
+        }
+        Apid = Decoder.NextApid++;
+        pthread_mutex_unlock(&Decoder.Lock);
+
+        if (Apid >= CCSDS_DECODER_MAX_APIDS)
+        {
+            break;
+        }
+        DecodeApid(Apid);
+    }
+    return NULL;
+}
+
+/************************************************************************
+** Main
+*************************************************************************/
+
+static void Usage(const char *Prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options] -o <outdir> <archive> [archive...]\n"
+            "  -o dir    output directory, created if needed\n"
+            "  -d file   packet dictionary from tlm_dict_gen.py\n"
+            "  -f fmt    archive format: ccsds (default) or tf\n"
+            "  -l bytes  transfer frame length (default 1115)\n"
+            "  -a        transfer frames are preceded by a 4 byte sync marker\n"
+            "  -c        transfer frames end with a frame error control field\n"
+            "  -e secs   seconds added to packet times (946684800 gives UNIX time)\n"
+            "  -j n      split and decode threads (default 4)\n",
+            Prog);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *DictPath = NULL;
+    int         Frames   = 0;
+    int         HasAsm   = 0;
+    int         HasFecf  = 0;
+    uint32      FrameLen = 1115;
+    int         Threads  = 4;
+    int         SplitThreads;
+    pthread_t   Workers[CCSDS_DECODER_MAX_THREADS];
+    uint64      TotalBytes = 0;
+    uint64      TotalPackets = 0;
+    double      Start, Split, Done;
+    FILE       *IndexFp;
+    char        Path[CCSDS_DECODER_PATH_LEN];
+    int         Opt, i;
+    uint32      s, Apid;
+
+    memset(&Decoder, 0, sizeof(Decoder));
+    Crc16Init();
+    pthread_mutex_init(&Decoder.Lock, NULL);
+
+    while ((Opt = getopt(argc, argv, "o:d:f:l:ace:j:h")) != -1)
+    {
+        switch (Opt)
+        {
+            case 'o': Decoder.OutDir = optarg; break;
+            case 'd': DictPath = optarg; break;
+            case 'f': Frames = (strcmp(optarg, "tf") == 0); break;
+            case 'l': FrameLen = (uint32)strtoul(optarg, NULL, 0); break;
+            case 'a': HasAsm = 1; break;
+            case 'c': HasFecf = 1; break;
+            case 'e': Decoder.EpochOffset = strtod(optarg, NULL); break;
+            case 'j': Threads = atoi(optarg); break;
+            default:  Usage(argv[0]); return 1;
+        }
+    }
+    if (Decoder.OutDir == NULL || optind >= argc || FrameLen <= CCSDS_DECODER_TF_HDR_LEN + 6)
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+    if (Threads < 1)
+    {
+        Threads = 1;
+    }
+    if (Threads > CCSDS_DECODER_MAX_THREADS)
+    {
+        Threads = CCSDS_DECODER_MAX_THREADS;
+    }
+    Decoder.Frames   = Frames;
+    Decoder.FrameLen = FrameLen;
+    Decoder.HasAsm   = HasAsm;
+    Decoder.HasFecf  = HasFecf;
+    if (DictPath != NULL && LoadDictionary(DictPath) != 0)
+    {
+        return 1;
+    }
+    if (mkdir(Decoder.OutDir, 0755) != 0 && errno != EEXIST)
+    {
+        fprintf(stderr, "Unable to create %s: %s\n", Decoder.OutDir, strerror(errno));
+        return 1;
+    }
+
+    Start = NowSeconds();
+    Decoder.SourceCount = (uint32)(argc - optind);
+    Decoder.Sources     = CheckedRealloc(NULL, Decoder.SourceCount * sizeof(Source_t));
+    memset(Decoder.Sources, 0, Decoder.SourceCount * sizeof(Source_t));
+
+    for (s = 0; s < Decoder.SourceCount; s++)
+    {
+        const char *Name = argv[optind + (int)s];
+        struct stat St;
+        int         Fd = open(Name, O_RDONLY);
+        void       *Map;
+
+        if (Fd < 0 || fstat(Fd, &St) != 0)
+        {
+            fprintf(stderr, "Unable to open %s: %s\n", Name, strerror(errno));
+            return 1;
+        }
+        if (St.st_size == 0)
+        {
+            close(Fd);
+            continue;
+        }
+        Map = mmap(NULL, (size_t)St.st_size, PROT_READ, MAP_PRIVATE, Fd, 0);
+        close(Fd);
+        if (Map == MAP_FAILED)
+        {
+            fprintf(stderr, "Unable to map %s: %s\n", Name, strerror(errno));
+            return 1;
+        }
+        posix_madvise(Map, (size_t)St.st_size, POSIX_MADV_SEQUENTIAL);
+        Decoder.Sources[s].Data = Map;
+        Decoder.Sources[s].Size = (uint64)St.st_size;
+        TotalBytes += (uint64)St.st_size;
+
+        if (!Frames)
+        {
+            posix_madvise(Map, (size_t)St.st_size, POSIX_MADV_WILLNEED);
+        }
+    }
+
+    SplitThreads = ((uint32)Threads < Decoder.SourceCount) ? Threads : (int)Decoder.SourceCount;
+    for (i = 0; i < SplitThreads; i++)
+    {
+        pthread_create(&Workers[i], NULL, SplitWorker, NULL);
+    }
+    for (i = 0; i < SplitThreads; i++)
+    {
+        pthread_join(Workers[i], NULL);
+    }
+    MergeSources();
+    Split = NowSeconds();
+
+    for (i = 0; i < Threads; i++)
+    {
+        pthread_create(&Workers[i], NULL, DecodeWorker, NULL);
+    }
+    for (i = 0; i < Threads; i++)
+    {
+        pthread_join(Workers[i], NULL);
+    }
+    Done = NowSeconds();
+
+    snprintf(Path, sizeof(Path), "%s/index.csv", Decoder.OutDir);
+    IndexFp = fopen(Path, "w");
+    if (IndexFp != NULL)
+    {
+        fprintf(IndexFp, "apid,name,packets,short_packets,first_time,last_time,columns\n");
+    }
+    for (Apid = 0; Apid < CCSDS_DECODER_MAX_APIDS; Apid++)
+    {
+        Stream_t *S = &Decoder.Streams[Apid];
+        if (S->Count == 0)
+        {
+            continue;
+        }
+        TotalPackets += S->Count;
+        if (IndexFp != NULL)
+        {
+            fprintf(IndexFp, "0x%03x,%s,%llu,%llu,%.6f,%.6f,%u\n", (unsigned int)Apid,
+                    Decoder.Dict[Apid] ? Decoder.Dict[Apid]->Name : "", (unsigned long long)S->Count,
+                    (unsigned long long)S->ShortPackets, S->FirstTime, S->LastTime,
+                    Decoder.Dict[Apid] ? (unsigned int)Decoder.Dict[Apid]->FieldCount : 0u);
+        }
+        free(S->Refs);
+    }
+    if (IndexFp != NULL)
+    {
+        fclose(IndexFp);
+    }
+
+    printf("%llu packets from %llu bytes: split %.3f s, decode %.3f s (%d threads), %.1f MB/s\n",
+           (unsigned long long)TotalPackets, (unsigned long long)TotalBytes, Split - Start, Done - Split, Threads,
+           (Done > Start) ? (double)TotalBytes / (Done - Start) / 1e6 : 0.0);
+    if (Decoder.BadHeaders || Decoder.BadFrames || Decoder.FrameGaps)
+    {
+        printf("%llu bad packet headers, %llu bad frames, %llu frame gaps\n", (unsigned long long)Decoder.BadHeaders,
+               (unsigned long long)Decoder.BadFrames, (unsigned long long)Decoder.FrameGaps);
+    }
+
+    for (s = 0; s < Decoder.SourceCount; s++)
+    {
+        if (Decoder.Sources[s].Owned != NULL)
+        {
+            free(Decoder.Sources[s].Owned);
+        }
+        else if (Decoder.Sources[s].Data != NULL)
+        {
+            munmap((void *)Decoder.Sources[s].Data, (size_t)Decoder.Sources[s].Size);
+        }
+    }
+    return 0;
+}
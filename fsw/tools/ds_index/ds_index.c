@@ -0,0 +1,401 @@
+/************************************************************************
+** File: ds_index.c
+**
+** Purpose:
+**  Host tool that builds the time to offset sidecar index for a DS file
+**  and extracts a time range from a DS file using that index.
+**
+** Notes:
+**  1. The index is written next to the DS file as <file>.idx, and an
+**     extract uses it so only the requested range is read.
+**  2. Sidecar layout, all fields big endian:
+**       header: "DSIX", uint16 version, uint16 interval, uint32 count,
+**               uint32 header bytes skipped at the start of the DS file
+**       entry:  uint32 seconds, uint16 subseconds, uint16 spare,
+**               uint32 byte offset of the packet in the DS file
+**
+*************************************************************************/
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DS_INDEX_MAGIC           "DSIX"
+#define DS_INDEX_VERSION         1
+#define DS_INDEX_HDR_LEN         16
+#define DS_INDEX_ENTRY_LEN       12
+#define DS_INDEX_FILE_HDR_LEN    140  /* cFE file header plus DS file header */
+#define DS_INDEX_PRI_HDR_LEN     6
+#define DS_INDEX_TLM_HDR_LEN     12
+#define DS_INDEX_MAX_PKT_LEN     65542
+#define DS_INDEX_PATH_LEN        1024
+
+typedef uint8_t  uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+
+typedef struct
+{
+    uint32 Seconds;
+    uint16 Subsecs;
+    uint32 Offset;
+} IndexEntry_t;
+
+typedef struct
+{
+    IndexEntry_t *Entries;
+    uint32        Count;
+    uint32        Interval;
+    uint32        HeaderLen;
+} Index_t;
+
+static uint8 PktBuf[DS_INDEX_MAX_PKT_LEN];
+
+/************************************************************************
+** Packet and index I/O
+*************************************************************************/
+
+static void PutU32(uint8 *p, uint32 v)
+{
+    p[0] = (uint8)(v >> 24);
+    p[1] = (uint8)(v >> 16);
+    p[2] = (uint8)(v >> 8);
+    p[3] = (uint8)v;
+}
+
+static void PutU16(uint8 *p, uint16 v)
+{
+    p[0] = (uint8)(v >> 8);
+    p[1] = (uint8)v;
+}
+
+static uint32 GetU32(const uint8 *p)
+{
+    return ((uint32)p[0] << 24) | ((uint32)p[1] << 16) | ((uint32)p[2] << 8) | p[3];
+}
+
+static uint16 GetU16(const uint8 *p)
+{
+    return (uint16)((p[0] << 8) | p[1]);
+}
+
+static double EntryTime(uint32 Seconds, uint16 Subsecs)
+{
+    return (double)Seconds + (double)Subsecs / 65536.0;
+}
+
+/* Read the next packet into PktBuf, returns its length or 0 at end of file */
+static uint32 ReadPacket(FILE *Fp)
+{
+    uint32 Len;
+
+    if (fread(PktBuf, 1, DS_INDEX_PRI_HDR_LEN, Fp) != DS_INDEX_PRI_HDR_LEN)
+    {
+        return 0;
+    }
+    Len = (uint32)GetU16(&PktBuf[4]) + 7;
+    if (fread(&PktBuf[DS_INDEX_PRI_HDR_LEN], 1, Len - DS_INDEX_PRI_HDR_LEN, Fp) != Len - DS_INDEX_PRI_HDR_LEN)
+    {
+        return 0;
+    }
+    return Len;
+}
+
+static int BuildIndex(FILE *Fp, uint32 HeaderLen, uint32 Interval, Index_t *Index)
+{
+    uint32 Cap = 0;
+    uint32 Packets = 0;
+    long   Offset = (long)HeaderLen;
+    uint32 Len;
+
+    memset(Index, 0, sizeof(*Index));
+    Index->Interval  = Interval;
+    Index->HeaderLen = HeaderLen;
+
+    if (fseek(Fp, Offset, SEEK_SET) != 0)
+    {
+        return -1;
+    }
+    while ((Len = ReadPacket(Fp)) != 0)
+    {
+        if ((Packets % Interval) == 0 && Len >= DS_INDEX_TLM_HDR_LEN)
+        {
+            if (Index->Count == Cap)
+            {
+                Cap = Cap ? Cap * 2 : 256;
+                Index->Entries = realloc(Index->Entries, Cap * sizeof(IndexEntry_t));
+                if (Index->Entries == NULL)
+                {
+                    return -1;
+                }
+            }
+            Index->Entries[Index->Count].Seconds = GetU32(&PktBuf[6]);
+            Index->Entries[Index->Count].Subsecs = GetU16(&PktBuf[10]);
+            Index->Entries[Index->Count].Offset  = (uint32)Offset;
+            Index->Count++;
+        }
+        Packets++;
+        Offset += (long)Len;
+    }
+    return 0;
+}
+
+static int WriteIndex(const char *Path, const Index_t *Index)
+{
+    FILE  *Fp = fopen(Path, "wb");
+    uint8  Buf[DS_INDEX_HDR_LEN];
+    uint32 i;
+
+    if (Fp == NULL)
+    {
+        fprintf(stderr, "Unable to create %s: %s\n", Path, strerror(errno));
+        return -1;
+    }
+    memcpy(Buf, DS_INDEX_MAGIC, 4);
+    PutU16(&Buf[4], DS_INDEX_VERSION);
+    PutU16(&Buf[6], (uint16)Index->Interval);
+    PutU32(&Buf[8], Index->Count);
+    PutU32(&Buf[12], Index->HeaderLen);
+    fwrite(Buf, 1, DS_INDEX_HDR_LEN, Fp);
+
+    for (i = 0; i < Index->Count; i++)
+    {
+        PutU32(&Buf[0], Index->Entries[i].Seconds);
+        PutU16(&Buf[4], Index->Entries[i].Subsecs);
+        PutU16(&Buf[6], 0);
+        PutU32(&Buf[8], Index->Entries[i].Offset);
+        fwrite(Buf, 1, DS_INDEX_ENTRY_LEN, Fp);
+    }
+    return fclose(Fp);
+}
+
+static int ReadIndex(const char *Path, Index_t *Index)
+{
+    FILE  *Fp = fopen(Path, "rb");
+    uint8  Buf[DS_INDEX_HDR_LEN];
+    uint32 i;
+    long   Size;
+
+    memset(Index, 0, sizeof(*Index));
+    if (Fp == NULL)
+    {
+        return -1;
+    }
+    if (fread(Buf, 1, DS_INDEX_HDR_LEN, Fp) != DS_INDEX_HDR_LEN || memcmp(Buf, DS_INDEX_MAGIC, 4) != 0 ||
+        GetU16(&Buf[4]) != DS_INDEX_VERSION)
+    {
+        fprintf(stderr, "%s is not a DS index file\n", Path);
+        fclose(Fp);
+        return -1;
+    }
+    Index->Interval  = GetU16(&Buf[6]);
+    Index->Count     = GetU32(&Buf[8]);
+    Index->HeaderLen = GetU32(&Buf[12]);
+
+    /* A sidecar cut short while being written holds fewer entries than its count */
+    if (fseek(Fp, 0, SEEK_END) != 0 || (Size = ftell(Fp)) < DS_INDEX_HDR_LEN ||
+        fseek(Fp, DS_INDEX_HDR_LEN, SEEK_SET) != 0)
+    {
+        fclose(Fp);
+        return -1;
+    }
+    if (Index->Count > (unsigned long)(Size - DS_INDEX_HDR_LEN) / DS_INDEX_ENTRY_LEN)
+    {
+        Index->Count = (uint32)((unsigned long)(Size - DS_INDEX_HDR_LEN) / DS_INDEX_ENTRY_LEN);
+    }
+    Index->Entries = malloc(((size_t)Index->Count + 1) * sizeof(IndexEntry_t));
+    if (Index->Entries == NULL)
+    {
+        fclose(Fp);
+        return -1;
+    }
+    for (i = 0; i < Index->Count; i++)
+    {
+        if (fread(Buf, 1, DS_INDEX_ENTRY_LEN, Fp) != DS_INDEX_ENTRY_LEN)
+        {
+            Index->Count = i;
+            break;
+        }
+        Index->Entries[i].Seconds = GetU32(&Buf[0]);
+        Index->Entries[i].Subsecs = GetU16(&Buf[4]);
+        Index->Entries[i].Offset  = GetU32(&Buf[8]);
+    }
+    fclose(Fp);
+    return 0;
+}
+
+/************************************************************************
+** Commands
+*************************************************************************/
+
+/*
+** Copy the file headers and every packet stamped within [Start, End].
+** Reading starts at the last index entry stamped before Start, since
+** packets ahead of an entry stamped at Start can share its time.  Reading
+** stops at the first index entry after End, since DS files are written in
+** time order.
+*/
+static int Extract(const char *DsPath, const char *OutPath, const Index_t *Index, double Start, double End)
+{
+    FILE  *In  = fopen(DsPath, "rb");
+    FILE  *Out = NULL;
+    uint32 First = 0;
+    long   StopOffset = -1;
+    long   Offset;
+    uint32 Len, Copied = 0, Read = 0;
+    uint32 i;
+
+    if (In == NULL)
+    {
+        fprintf(stderr, "Unable to open %s: %s\n", DsPath, strerror(errno));
+        return -1;
+    }
+    Out = fopen(OutPath, "wb");
+    if (Out == NULL)
+    {
+        fprintf(stderr, "Unable to create %s: %s\n", OutPath, strerror(errno));
+        fclose(In);
+        return -1;
+    }
+
+    /* The file headers are kept so the result is itself a valid DS file */
+    if (Index->HeaderLen > 0)
+    {
+        uint8 *Hdr = malloc(Index->HeaderLen);
+        if (Hdr == NULL || fread(Hdr, 1, Index->HeaderLen, In) != Index->HeaderLen)
+        {
+            fprintf(stderr, "Unable to read the file headers of %s\n", DsPath);
+            free(Hdr);
+            fclose(In);
+            fclose(Out);
+            return -1;
+        }
+        fwrite(Hdr, 1, Index->HeaderLen, Out);
+        free(Hdr);
+    }
+
+    for (i = 0; i < Index->Count; i++)
+    {
+        double t = EntryTime(Index->Entries[i].Seconds, Index->Entries[i].Subsecs);
+        if (t < Start)
+        {
+            First = i;
+        }
+        if (t > End)
+        {
+            StopOffset = (long)Index->Entries[i].Offset;
+            break;
+        }
+    }
+    Offset = (Index->Count > 0) ? (long)Index->Entries[First].Offset : (long)Index->HeaderLen;
+
+    if (fseek(In, Offset, SEEK_SET) == 0)
+    {
+        while ((StopOffset < 0 || Offset < StopOffset) && (Len = ReadPacket(In)) != 0)
+        {
+            Read++;
+            Offset += (long)Len;
+            if (Len >= DS_INDEX_TLM_HDR_LEN)
+            {
+                double t = EntryTime(GetU32(&PktBuf[6]), GetU16(&PktBuf[10]));
+                if (t >= Start && t <= End)
+                {
+                    fwrite(PktBuf, 1, Len, Out);
+                    Copied++;
+                }
+            }
+        }
+    }
+
+    printf("%u packets extracted, %u packets read\n", Copied, Read);
+    fclose(In);
+    return fclose(Out);
+}
+
+static void Usage(const char *Prog)
+{
+    fprintf(stderr,
+            "Usage: %s build [-n packets] [-s bytes] <file.ds>\n"
+            "       %s extract -b start -e end [-s bytes] <file.ds> <out.ds>\n"
+            "  -n packets  packets per index entry (default 64)\n"
+            "  -s bytes    file header bytes before the first packet (default %d)\n"
+            "  -b, -e      range of packet times in seconds, inclusive\n"
+            "  The index <file.ds>.idx is built if extract does not find one\n",
+            Prog, Prog, DS_INDEX_FILE_HDR_LEN);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32  Interval  = 64;
+    uint32  HeaderLen = DS_INDEX_FILE_HDR_LEN;
+    double  Start = 0.0, End = -1.0;
+    char    IdxPath[DS_INDEX_PATH_LEN];
+    Index_t Index;
+    int     Build, i;
+    int     Status = 0;
+    const char *Files[2] = {NULL, NULL};
+    int     NumFiles = 0;
+
+    if (argc < 3 || (strcmp(argv[1], "build") != 0 && strcmp(argv[1], "extract") != 0))
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+    Build = (strcmp(argv[1], "build") == 0);
+
+    for (i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            Interval = (uint32)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            HeaderLen = (uint32)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+        {
+            Start = strtod(argv[++i], NULL);
+        }
+        else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+        {
+            End = strtod(argv[++i], NULL);
+        }
+        else if (NumFiles < 2)
+        {
+            Files[NumFiles++] = argv[i];
+        }
+    }
+    if (Files[0] == NULL || Interval == 0 || Interval > 0xFFFF || (!Build && (Files[1] == NULL || End < Start)))
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+    snprintf(IdxPath, sizeof(IdxPath), "%s.idx", Files[0]);
+
+    if (Build || ReadIndex(IdxPath, &Index) != 0)
+    {
+        FILE *Fp = fopen(Files[0], "rb");
+        if (Fp == NULL)
+        {
+            fprintf(stderr, "Unable to open %s: %s\n", Files[0], strerror(errno));
+            return 1;
+        }
+        Status = BuildIndex(Fp, HeaderLen, Interval, &Index);
+        fclose(Fp);
+        if (Status == 0)
+        {
+            Status = WriteIndex(IdxPath, &Index);
+            printf("%u index entries written to %s\n", Index.Count, IdxPath);
+        }
+    }
+    if (Status == 0 && !Build)
+    {
+        Status = Extract(Files[0], Files[1], &Index, Start, End);
+    }
+
+    free(Index.Entries);
+    return (Status == 0) ? 0 : 1;
+}
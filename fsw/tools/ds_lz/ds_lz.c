@@ -0,0 +1,323 @@
+/************************************************************************
+** File: ds_lz.c
+**
+** Purpose:
+**  Self contained LZ77 class codec for closed DS files.
+**
+** Notes:
+**  1. Each block is a series of sequences: a token byte whose high nibble
+**     is the literal count and low nibble the match length minus 4, extra
+**     length bytes when a nibble is 15, the literals, then a 16 bit little
+**     endian match offset.  The last sequence of a block has literals only.
+**  2. Matches are found with a single entry hash of the next four bytes,
+**     which favors speed over ratio.  That suits a low priority task
+**     compressing repetitive housekeeping packets.
+**
+*************************************************************************/
+
+#include <string.h>
+
+#include "ds_lz.h"
+
+#define DS_LZ_MIN_MATCH   4
+#define DS_LZ_MAX_OFFSET  65535
+#define DS_LZ_NIBBLE_MAX  15
+
+static uint32_t DS_LZ_Read32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t DS_LZ_Hash(uint32_t Value)
+{
+    return (Value * 2654435761u) >> (32 - DS_LZ_HASH_BITS);
+}
+
+static void DS_LZ_PutU32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static uint32_t DS_LZ_GetU32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/* Write a length that did not fit its nibble as a run of 255s and a remainder */
+static uint8_t *DS_LZ_PutLength(uint8_t *Op, size_t Len)
+{
+    while (Len >= 255)
+    {
+        *Op++ = 255;
+        Len -= 255;
+    }
+    *Op++ = (uint8_t)Len;
+    return Op;
+}
+
+static uint8_t *DS_LZ_PutSequence(uint8_t *Op, const uint8_t *Literals, size_t LitLen, size_t Offset, size_t MatchLen)
+{
+    uint8_t *Token = Op++;
+    size_t   Code  = (MatchLen > 0) ? MatchLen - DS_LZ_MIN_MATCH : 0;
+
+    *Token = (uint8_t)(((LitLen < DS_LZ_NIBBLE_MAX) ? LitLen : DS_LZ_NIBBLE_MAX) << 4);
+    if (LitLen >= DS_LZ_NIBBLE_MAX)
+    {
+        Op = DS_LZ_PutLength(Op, LitLen - DS_LZ_NIBBLE_MAX);
+    }
+    memcpy(Op, Literals, LitLen);
+    Op += LitLen;
+
+    if (MatchLen > 0)
+    {
+        *Op++ = (uint8_t)Offset;
+        *Op++ = (uint8_t)(Offset >> 8);
+        *Token |= (uint8_t)((Code < DS_LZ_NIBBLE_MAX) ? Code : DS_LZ_NIBBLE_MAX);
+        if (Code >= DS_LZ_NIBBLE_MAX)
+        {
+            Op = DS_LZ_PutLength(Op, Code - DS_LZ_NIBBLE_MAX);
+        }
+    }
+    return Op;
+}
+
+size_t DS_LZ_CompressBlock(const uint8_t *Src, size_t SrcLen, uint8_t *Dst, size_t DstCap, uint16_t *Table)
+{
+    size_t   Ip     = 0;
+    size_t   Anchor = 0;
+    uint8_t *Op     = Dst;
+
+    if (SrcLen > DS_LZ_BLOCK_SIZE || DstCap < DS_LZ_MAX_COMPRESSED(SrcLen))
+    {
+        return 0;
+    }
+    memset(Table, 0, DS_LZ_HASH_SIZE * sizeof(uint16_t));
+
+    while (Ip + DS_LZ_MIN_MATCH <= SrcLen)
+    {
+        uint32_t Seq = DS_LZ_Read32(&Src[Ip]);
+        uint32_t h   = DS_LZ_Hash(Seq);
+        size_t   Ref = Table[h];
+
+        Table[h] = (uint16_t)Ip;
+        if (Ref < Ip && Ip - Ref <= DS_LZ_MAX_OFFSET && DS_LZ_Read32(&Src[Ref]) == Seq)
+        {
+            size_t Len = DS_LZ_MIN_MATCH;
+            while (Ip + Len < SrcLen && Src[Ref + Len] == Src[Ip + Len])
+            {
+                Len++;
+            }
+            Op = DS_LZ_PutSequence(Op, &Src[Anchor], Ip - Anchor, Ip - Ref, Len);
+            Ip += Len;
+            Anchor = Ip;
+        }
+        else
+        {
+            /* Step faster through data that is not matching */
+            Ip += 1 + ((Ip - Anchor) >> 6);
+        }
+    }
+
+    Op = DS_LZ_PutSequence(Op, &Src[Anchor], SrcLen - Anchor, 0, 0);
+    return (size_t)(Op - Dst);
+}
+
+/* Read an extended length, returns 0 on overrun */
+static int DS_LZ_GetLength(const uint8_t **Ip, const uint8_t *End, size_t *Len)
+{
+    uint8_t b;
+    do
+    {
+        if (*Ip >= End)
+        {
+            return 0;
+        }
+        b = *(*Ip)++;
+        *Len += b;
+    } while (b == 255);
+    return 1;
+}
+
+long DS_LZ_DecompressBlock(const uint8_t *Src, size_t SrcLen, uint8_t *Dst, size_t DstCap)
+{
+    const uint8_t *Ip  = Src;
+    const uint8_t *End = Src + SrcLen;
+    size_t         Op  = 0;
+
+    while (Ip < End)
+    {
+        uint8_t Token  = *Ip++;
+        size_t  LitLen = Token >> 4;
+        size_t  MatchLen;
+        size_t  Offset;
+
+        if (LitLen == DS_LZ_NIBBLE_MAX && !DS_LZ_GetLength(&Ip, End, &LitLen))
+        {
+            return -1;
+        }
+        if (LitLen > (size_t)(End - Ip) || LitLen > DstCap - Op)
+        {
+            return -1;
+        }
+        memcpy(&Dst[Op], Ip, LitLen);
+        Ip += LitLen;
+        Op += LitLen;
+
+        if (Ip == End)
+        {
+            break;
+        }
+        if (End - Ip < 2)
+        {
+            return -1;
+        }
+        Offset = (size_t)Ip[0] | ((size_t)Ip[1] << 8);
+        Ip += 2;
+        MatchLen = Token & DS_LZ_NIBBLE_MAX;
+        if (MatchLen == DS_LZ_NIBBLE_MAX && !DS_LZ_GetLength(&Ip, End, &MatchLen))
+        {
+            return -1;
+        }
+        MatchLen += DS_LZ_MIN_MATCH;
+        if (Offset == 0 || Offset > Op || MatchLen > DstCap - Op)
+        {
+            return -1;
+        }
+
+        /* Byte copy since the match may overlap the output it is copying */
+        while (MatchLen-- > 0)
+        {
+            Dst[Op] = Dst[Op - Offset];
+            Op++;
+        }
+    }
+    return (long)Op;
+}
+
+uint32_t DS_LZ_Adler32(const uint8_t *Data, size_t Len)
+{
+    uint32_t a = 1, b = 0;
+    size_t   i;
+
+    while (Len > 0)
+    {
+        /* 5552 is the most bytes that can be summed before b may overflow */
+        size_t n = (Len < 5552) ? Len : 5552;
+        for (i = 0; i < n; i++)
+        {
+            a += Data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        Data += n;
+        Len -= n;
+    }
+    return (b << 16) | a;
+}
+
+int DS_LZ_CompressFile(FILE *In, FILE *Out, DS_LZ_Work_t *Work)
+{
+    uint8_t Hdr[DS_LZ_BLOCK_HDR_LEN];
+    size_t  RawLen;
+
+    memcpy(Hdr, DS_LZ_MAGIC, 4);
+    Hdr[4] = DS_LZ_VERSION;
+    Hdr[5] = Hdr[6] = Hdr[7] = 0;
+    if (fwrite(Hdr, 1, DS_LZ_FILE_HDR_LEN, Out) != DS_LZ_FILE_HDR_LEN)
+    {
+        return DS_LZ_ERR_IO;
+    }
+
+    while ((RawLen = fread(Work->Raw, 1, DS_LZ_BLOCK_SIZE, In)) > 0)
+    {
+        size_t         PackedLen = DS_LZ_CompressBlock(Work->Raw, RawLen, Work->Packed, sizeof(Work->Packed), Work->Table);
+        const uint8_t *Body      = Work->Packed;
+        uint32_t       Flags     = 0;
+
+        if (PackedLen == 0 || PackedLen >= RawLen)
+        {
+            Body      = Work->Raw;
+            PackedLen = RawLen;
+            Flags     = DS_LZ_STORED_FLAG;
+        }
+        DS_LZ_PutU32(&Hdr[0], (uint32_t)RawLen | Flags);
+        DS_LZ_PutU32(&Hdr[4], (uint32_t)PackedLen);
+        DS_LZ_PutU32(&Hdr[8], DS_LZ_Adler32(Work->Raw, RawLen));
+        if (fwrite(Hdr, 1, DS_LZ_BLOCK_HDR_LEN, Out) != DS_LZ_BLOCK_HDR_LEN ||
+            fwrite(Body, 1, PackedLen, Out) != PackedLen)
+        {
+            return DS_LZ_ERR_IO;
+        }
+    }
+    if (ferror(In))
+    {
+        return DS_LZ_ERR_IO;
+    }
+
+    memset(Hdr, 0, sizeof(Hdr));
+    return (fwrite(Hdr, 1, DS_LZ_BLOCK_HDR_LEN, Out) == DS_LZ_BLOCK_HDR_LEN) ? DS_LZ_SUCCESS : DS_LZ_ERR_IO;
+}
+
+int DS_LZ_DecompressFile(FILE *In, FILE *Out, DS_LZ_Work_t *Work)
+{
+    uint8_t Hdr[DS_LZ_BLOCK_HDR_LEN];
+
+    if (fread(Hdr, 1, DS_LZ_FILE_HDR_LEN, In) != DS_LZ_FILE_HDR_LEN || memcmp(Hdr, DS_LZ_MAGIC, 4) != 0 ||
+        Hdr[4] != DS_LZ_VERSION)
+    {
+        return DS_LZ_ERR_FORMAT;
+    }
+
+    for (;;)
+    {
+        uint32_t       RawWord, PackedLen, Check;
+        size_t         RawLen;
+        const uint8_t *Body = Work->Packed;
+
+        if (fread(Hdr, 1, DS_LZ_BLOCK_HDR_LEN, In) != DS_LZ_BLOCK_HDR_LEN)
+        {
+            return DS_LZ_ERR_FORMAT;
+        }
+        RawWord   = DS_LZ_GetU32(&Hdr[0]);
+        PackedLen = DS_LZ_GetU32(&Hdr[4]);
+        Check     = DS_LZ_GetU32(&Hdr[8]);
+        RawLen    = RawWord & ~DS_LZ_STORED_FLAG;
+        if (RawLen == 0)
+        {
+            return DS_LZ_SUCCESS;
+        }
+        if (RawLen > DS_LZ_BLOCK_SIZE || PackedLen > sizeof(Work->Packed) ||
+            fread(Work->Packed, 1, PackedLen, In) != PackedLen)
+        {
+            return DS_LZ_ERR_FORMAT;
+        }
+
+        if (RawWord & DS_LZ_STORED_FLAG)
+        {
+            if (PackedLen != RawLen)
+            {
+                return DS_LZ_ERR_FORMAT;
+            }
+        }
+        else
+        {
+            if (DS_LZ_DecompressBlock(Work->Packed, PackedLen, Work->Raw, DS_LZ_BLOCK_SIZE) != (long)RawLen)
+            {
+                return DS_LZ_ERR_FORMAT;
+            }
+            Body = Work->Raw;
+        }
+        if (DS_LZ_Adler32(Body, RawLen) != Check)
+        {
+            return DS_LZ_ERR_CHECKSUM;
+        }
+        if (fwrite(Body, 1, RawLen, Out) != RawLen)
+        {
+            return DS_LZ_ERR_IO;
+        }
+    }
+}
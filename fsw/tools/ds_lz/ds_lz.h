@@ -0,0 +1,65 @@
+/************************************************************************
+** File: ds_lz.h
+**
+** Purpose:
+**  Self contained LZ77 class codec for closed DS files.
+**
+** Notes:
+**  1. The codec uses no dynamic memory and no library other than the C
+**     standard library, so the same source can be built into an on-board
+**     app as well as the ground side ds_lz tool.
+**  2. Files are split into independent blocks of at most DS_LZ_BLOCK_SIZE
+**     bytes.  Each block header holds the raw length, compressed length and
+**     Adler-32 of the raw data, big endian.  Blocks that do not shrink are
+**     stored raw.  A block with a raw length of zero ends the file.
+**
+*************************************************************************/
+
+#ifndef DS_LZ_H
+#define DS_LZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define DS_LZ_MAGIC            "DSLZ"
+#define DS_LZ_VERSION          1
+#define DS_LZ_FILE_HDR_LEN     8
+#define DS_LZ_BLOCK_HDR_LEN    12
+#define DS_LZ_BLOCK_SIZE       65536
+#define DS_LZ_STORED_FLAG      0x80000000u
+#define DS_LZ_HASH_BITS        12
+#define DS_LZ_HASH_SIZE        (1 << DS_LZ_HASH_BITS)
+
+/* Worst case compressed size of one block, before falling back to stored */
+#define DS_LZ_MAX_COMPRESSED(n) ((n) + ((n) / 255) + 16)
+
+#define DS_LZ_SUCCESS          0
+#define DS_LZ_ERR_IO          -1
+#define DS_LZ_ERR_FORMAT      -2
+#define DS_LZ_ERR_CHECKSUM    -3
+
+/*
+** Working memory for one compressor, kept by the caller so the codec can
+** run from a child task without allocating
+*/
+typedef struct
+{
+    uint16_t Table[DS_LZ_HASH_SIZE];
+    uint8_t  Raw[DS_LZ_BLOCK_SIZE];
+    uint8_t  Packed[DS_LZ_MAX_COMPRESSED(DS_LZ_BLOCK_SIZE)];
+} DS_LZ_Work_t;
+
+/* Compress one block of at most DS_LZ_BLOCK_SIZE bytes, returns the output length or 0 if it does not fit */
+size_t DS_LZ_CompressBlock(const uint8_t *Src, size_t SrcLen, uint8_t *Dst, size_t DstCap, uint16_t *Table);
+
+/* Decompress one block, returns the output length or -1 if the data is corrupt */
+long DS_LZ_DecompressBlock(const uint8_t *Src, size_t SrcLen, uint8_t *Dst, size_t DstCap);
+
+uint32_t DS_LZ_Adler32(const uint8_t *Data, size_t Len);
+
+/* Stream a whole file, returning DS_LZ_SUCCESS or one of the DS_LZ_ERR codes */
+int DS_LZ_CompressFile(FILE *In, FILE *Out, DS_LZ_Work_t *Work);
+int DS_LZ_DecompressFile(FILE *In, FILE *Out, DS_LZ_Work_t *Work);
+
+#endif /* DS_LZ_H */
@@ -0,0 +1,217 @@
+/************************************************************************
+** File: ds_lz_tool.c
+**
+** Purpose:
+**  Ground side compressor, decompressor and benchmark for DS .lz files.
+**
+** Notes:
+**  1. "ds_lz -d file.ds.lz" restores file.ds.  "ds_lz file.ds" produces
+**     file.ds.lz in the block format described in ds_lz.h.
+**  2. "ds_lz -b files..." reports the ratio and the CPU time per megabyte
+**     for each file, so recorded NOS3 data can be used to judge the cost
+**     of enabling compression for a DS destination file.
+**
+*************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ds_lz.h"
+
+#define DS_LZ_TOOL_PATH_LEN 1024
+#define DS_LZ_TOOL_EXT      ".lz"
+
+static DS_LZ_Work_t Work;
+
+static int ProcessFile(const char *InPath, const char *OutPath, int Decompress)
+{
+    FILE *In  = fopen(InPath, "rb");
+    FILE *Out = NULL;
+    int   Status;
+
+    if (In == NULL)
+    {
+        fprintf(stderr, "Unable to open %s: %s\n", InPath, strerror(errno));
+        return 1;
+    }
+    Out = fopen(OutPath, "wb");
+    if (Out == NULL)
+    {
+        fprintf(stderr, "Unable to create %s: %s\n", OutPath, strerror(errno));
+        fclose(In);
+        return 1;
+    }
+
+    Status = Decompress ? DS_LZ_DecompressFile(In, Out, &Work) : DS_LZ_CompressFile(In, Out, &Work);
+    fclose(In);
+    if (fclose(Out) != 0 && Status == DS_LZ_SUCCESS)
+    {
+        Status = DS_LZ_ERR_IO;
+    }
+    if (Status != DS_LZ_SUCCESS)
+    {
+        fprintf(stderr, "%s: %s\n", InPath,
+                Status == DS_LZ_ERR_CHECKSUM ? "checksum mismatch" :
+                Status == DS_LZ_ERR_FORMAT   ? "not a valid DS LZ file" : "read or write failed");
+        remove(OutPath);
+        return 1;
+    }
+    return 0;
+}
+
+static int Benchmark(const char *Path)
+{
+    FILE          *Fp = fopen(Path, "rb");
+    uint8_t       *Raw;
+    uint8_t       *Packed;
+    uint8_t       *Check;
+    long           Size;
+    size_t         Pos, PackedTotal = 0;
+    clock_t        Start;
+    double         CompSecs, DecompSecs;
+    int            Reps, r;
+
+    if (Fp == NULL || fseek(Fp, 0, SEEK_END) != 0 || (Size = ftell(Fp)) <= 0)
+    {
+        fprintf(stderr, "Unable to read %s\n", Path);
+        if (Fp != NULL)
+        {
+            fclose(Fp);
+        }
+        return 1;
+    }
+    rewind(Fp);
+    Raw    = malloc((size_t)Size);
+    Check  = malloc(DS_LZ_BLOCK_SIZE);
+    Packed = malloc(((size_t)Size / DS_LZ_BLOCK_SIZE + 1) * DS_LZ_MAX_COMPRESSED(DS_LZ_BLOCK_SIZE));
+    if (Raw == NULL || Check == NULL || Packed == NULL || fread(Raw, 1, (size_t)Size, Fp) != (size_t)Size)
+    {
+        fprintf(stderr, "Unable to read %s\n", Path);
+        fclose(Fp);
+        free(Raw);
+        free(Check);
+        free(Packed);
+        return 1;
+    }
+    fclose(Fp);
+
+    /* Repeat small files so the timing is not dominated by clock resolution */
+    Reps = (int)(64L * 1024 * 1024 / Size) + 1;
+
+    Start = clock();
+    for (r = 0; r < Reps; r++)
+    {
+        PackedTotal = 0;
+        for (Pos = 0; Pos < (size_t)Size; Pos += DS_LZ_BLOCK_SIZE)
+        {
+            size_t Len = ((size_t)Size - Pos < DS_LZ_BLOCK_SIZE) ? (size_t)Size - Pos : DS_LZ_BLOCK_SIZE;
+            size_t Out = DS_LZ_CompressBlock(&Raw[Pos], Len, &Packed[PackedTotal + 4],
+                                             DS_LZ_MAX_COMPRESSED(DS_LZ_BLOCK_SIZE), Work.Table);
+            Packed[PackedTotal]     = (uint8_t)(Out >> 16);
+            Packed[PackedTotal + 1] = (uint8_t)(Out >> 8);
+            Packed[PackedTotal + 2] = (uint8_t)Out;
+            Packed[PackedTotal + 3] = 0;
+            PackedTotal += Out + 4;
+        }
+    }
+    CompSecs = (double)(clock() - Start) / CLOCKS_PER_SEC / Reps;
+
+    Start = clock();
+    for (r = 0; r < Reps; r++)
+    {
+        size_t In = 0;
+        for (Pos = 0; Pos < (size_t)Size; Pos += DS_LZ_BLOCK_SIZE)
+        {
+            size_t Len = ((size_t)Size - Pos < DS_LZ_BLOCK_SIZE) ? (size_t)Size - Pos : DS_LZ_BLOCK_SIZE;
+            size_t Out = ((size_t)Packed[In] << 16) | ((size_t)Packed[In + 1] << 8) | Packed[In + 2];
+            if (DS_LZ_DecompressBlock(&Packed[In + 4], Out, Check, DS_LZ_BLOCK_SIZE) != (long)Len ||
+                memcmp(Check, &Raw[Pos], Len) != 0)
+            {
+                fprintf(stderr, "%s: round trip mismatch at offset %lu\n", Path, (unsigned long)Pos);
+                free(Raw);
+                free(Check);
+                free(Packed);
+                return 1;
+            }
+            In += Out + 4;
+        }
+    }
+    DecompSecs = (double)(clock() - Start) / CLOCKS_PER_SEC / Reps;
+
+    printf("%-40s %10ld %10lu %6.2f %10.2f %10.2f\n", Path, Size, (unsigned long)PackedTotal,
+           (double)Size / (double)PackedTotal, CompSecs * 1e3 / ((double)Size / 1048576.0),
+           DecompSecs * 1e3 / ((double)Size / 1048576.0));
+    free(Raw);
+    free(Check);
+    free(Packed);
+    return 0;
+}
+
+static void Usage(const char *Prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-d] <file> [out]\n"
+            "       %s -b <file> [file...]\n"
+            "  -d  decompress a .lz file\n"
+            "  -b  benchmark ratio and CPU time per megabyte\n",
+            Prog, Prog);
+}
+
+int main(int argc, char *argv[])
+{
+    char OutPath[DS_LZ_TOOL_PATH_LEN];
+    int  Decompress = 0;
+    int  Arg = 1;
+    int  Status = 0;
+
+    if (argc > 1 && strcmp(argv[1], "-b") == 0)
+    {
+        if (argc < 3)
+        {
+            Usage(argv[0]);
+            return 1;
+        }
+        printf("%-40s %10s %10s %6s %10s %10s\n", "file", "bytes", "packed", "ratio", "comp ms/MB", "dec ms/MB");
+        for (Arg = 2; Arg < argc; Arg++)
+        {
+            Status |= Benchmark(argv[Arg]);
+        }
+        return Status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "-d") == 0)
+    {
+        Decompress = 1;
+        Arg++;
+    }
+    if (Arg >= argc)
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    if (Arg + 1 < argc)
+    {
+        snprintf(OutPath, sizeof(OutPath), "%s", argv[Arg + 1]);
+    }
+    else if (Decompress)
+    {
+        size_t Len = strlen(argv[Arg]);
+        size_t Ext = strlen(DS_LZ_TOOL_EXT);
+        if (Len <= Ext || strcmp(&argv[Arg][Len - Ext], DS_LZ_TOOL_EXT) != 0)
+        {
+            fprintf(stderr, "%s does not end in %s, give an output name\n", argv[Arg], DS_LZ_TOOL_EXT);
+            return 1;
+        }
+        snprintf(OutPath, sizeof(OutPath), "%.*s", (int)(Len - Ext), argv[Arg]);
+    }
+    else
+    {
+        snprintf(OutPath, sizeof(OutPath), "%s%s", argv[Arg], DS_LZ_TOOL_EXT);
+    }
+
+    return ProcessFile(argv[Arg], OutPath, Decompress);
+}
@@ -0,0 +1,147 @@
+#
+# Convenience script for NOS3 development
+# Build and inspect camera image pack files
+#   Script assumes run from top level directory of NOS3 repo
+#
+# The pack holds pre-encoded JPEG frames in one file that a reader can memory
+# map, so serving a frame needs no encoding or per frame file reads.  Each
+# frame is tagged with its resolution and the camera boresight direction, in
+# the spacecraft LVLH frame, that it was rendered for, so a reader can pick the
+# frame at a given resolution that points closest to a given boresight.  The
+# camera simulator in this tree does not read packs.
+#
+# Layout, all fields big endian:
+#   header: "NIMG", uint16 version, uint16 frame count, uint32 entry table
+#           offset, uint32 page size, 16 spare bytes (32 bytes total)
+#   entry:  uint16 width, uint16 height, float32 x, y, z boresight unit
+#           vector, uint64 offset, uint32 length, uint32 CRC-32 (32 bytes)
+# Frames start on page boundaries so each one maps and prefetches as whole pages.
+#
+# The manifest is a CSV of JPEG file and boresight x, y, z:
+#   nadir_640.jpg,0,0,1
+#   nadir_2592.jpg,0,0,1
+#
+# Examples:
+#   python3 ./scripts/cam_image_pack.py build -m images/manifest.csv -o ./sims/build/bin/cam_images.pack
+#   python3 ./scripts/cam_image_pack.py list ./sims/build/bin/cam_images.pack --verify
+#
+
+import argparse
+import csv
+import math
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = b'NIMG'
+VERSION = 1
+HDR_FMT = '>4sHHII16x'
+ENTRY_FMT = '>HH3fQII'
+PAGE_SIZE = 4096
+OV5640_SIZES = {(320, 240), (640, 480), (1024, 768), (1280, 960), (1600, 1200), (2048, 1536), (2592, 1944)}
+
+
+def jpeg_size(data):
+    # Width and height from the first start of frame marker
+    if data[:2] != b'\xff\xd8':
+        return None
+    pos = 2
+    while pos + 4 <= len(data):
+        if data[pos] != 0xFF:
+            return None
+        marker = data[pos + 1]
+        seg_len = struct.unpack('>H', data[pos + 2:pos + 4])[0]
+        if marker in (0xC0, 0xC1, 0xC2) and pos + 9 <= len(data):
+            height, width = struct.unpack('>HH', data[pos + 5:pos + 9])
+            return width, height
+        pos += 2 + seg_len
+    return None
+
+
+def build(args):
+    base = os.path.dirname(os.path.abspath(args.manifest))
+    frames = []
+    with open(args.manifest, 'r') as fp:
+        for row in csv.reader(fp):
+            if not row or row[0].startswith('#') or row[0] == 'file':
+                continue
+            path = row[0] if os.path.isabs(row[0]) else os.path.join(base, row[0])
+            x, y, z = (float(v) for v in row[1:4])
+            norm = math.sqrt(x * x + y * y + z * z)
+            if norm == 0.0:
+                raise ValueError('%s has a zero boresight vector' % row[0])
+            with open(path, 'rb') as img:
+                data = img.read()
+            size = jpeg_size(data)
+            if size is None:
+                raise ValueError('%s is not a baseline or progressive JPEG' % row[0])
+            if size not in OV5640_SIZES:
+                print('  %s is %dx%d, which is not an OV5640 capture size' % (row[0], size[0], size[1]))
+            frames.append((size, (x / norm, y / norm, z / norm), data))
+
+    if not frames or len(frames) > 0xFFFF:
+        raise ValueError('the manifest must list between 1 and 65535 frames')
+
+    table_off = struct.calcsize(HDR_FMT)
+    offset = table_off + len(frames) * struct.calcsize(ENTRY_FMT)
+    entries = []
+    for size, vec, data in frames:
+        offset = (offset + PAGE_SIZE - 1) // PAGE_SIZE * PAGE_SIZE
+        entries.append(struct.pack(ENTRY_FMT, size[0], size[1], vec[0], vec[1], vec[2], offset, len(data),
+                                   zlib.crc32(data)))
+        offset += len(data)
+
+    with open(args.output, 'wb') as out:
+        out.write(struct.pack(HDR_FMT, MAGIC, VERSION, len(frames), table_off, PAGE_SIZE))
+        out.write(b''.join(entries))
+        for entry, (_, _, data) in zip(entries, frames):
+            out.seek(struct.unpack(ENTRY_FMT, entry)[5])
+            out.write(data)
+    print('  %d frames, %d bytes written to %s' % (len(frames), offset, args.output))
+
+
+def list_pack(args):
+    with open(args.pack, 'rb') as fp:
+        data = fp.read()
+    magic, version, count, table_off, page = struct.unpack_from(HDR_FMT, data, 0)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError('%s is not a version %d image pack' % (args.pack, VERSION))
+    print('%s: %d frames, %d byte pages' % (args.pack, count, page))
+    bad = 0
+    for i in range(count):
+        w, h, x, y, z, off, length, crc = struct.unpack_from(ENTRY_FMT, data, table_off + i * struct.calcsize(ENTRY_FMT))
+        status = ''
+        if args.verify:
+            ok = off + length <= len(data) and zlib.crc32(data[off:off + length]) == crc
+            status = 'ok' if ok else 'BAD'
+            bad += 0 if ok else 1
+        print('  %4d %4dx%-4d (%7.4f %7.4f %7.4f) %10d %9d %s' % (i, w, h, x, y, z, off, length, status))
+    return bad
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Build and inspect camera image packs')
+    sub = parser.add_subparsers(dest='cmd', required=True)
+    b = sub.add_parser('build', help='pack the JPEG frames listed in a manifest')
+    b.add_argument('-m', '--manifest', required=True, help='CSV of JPEG file and boresight x, y, z')
+    b.add_argument('-o', '--output', default='cam_images.pack', help='pack file to write')
+    l = sub.add_parser('list', help='list the frames in a pack')
+    l.add_argument('pack', help='pack file to read')
+    l.add_argument('--verify', action='store_true', help='check the CRC of every frame')
+    args = parser.parse_args()
+
+    try:
+        if args.cmd == 'build':
+            build(args)
+        elif list_pack(args):
+            print('  frames failed verification')
+            sys.exit(1)
+    except (OSError, ValueError, struct.error) as err:
+        print(err)
+        print('Exiting due to error...')
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -5,7 +5,10 @@
 #
 
 import datetime
+import glob
 import os
+import re
+import sys
 import xml.etree.ElementTree as ET
 
 # Parse mission configuration
@@ -67,6 +70,39 @@ if (gsw_identified == 0):
     print('Invalid GSW in configuration file!')
     print('Exiting due to error...')
 
+# DS filter table - each MID may only own one packet entry
+ds_mids = {}
+ds_defines = {}
+for hdr in glob.glob('./cfg/nos3_defs/*.h') + glob.glob('./components/*/fsw/**/*msgids.h', recursive=True) + glob.glob('./fsw/apps/*/fsw/**/*msgids.h', recursive=True):
+    with open(hdr, 'r', errors='replace') as fp:
+        for line in fp:
+            m = re.match(r'\s*#\s*define\s+(\w+)\s+([^/]+)', line)
+            if m:
+                ds_defines.setdefault(m.group(1), m.group(2).strip())
+
+def ds_mid_value(name, depth=0):
+    expr = ds_defines.get(name)
+    if expr is None or depth > 8:
+        return name
+    expr = re.sub(r'[A-Za-z_]\w*', lambda t: str(ds_mid_value(t.group(0), depth + 1)), expr)
+    try:
+        return hex(eval(expr, {'__builtins__': {}}))
+    except Exception:
+        return name
+
+with open('./cfg/nos3_defs/tables/ds_filter_tbl.c', 'r') as fp:
+    for line_num, line in enumerate(fp, 1):
+        m = re.search(r'^\s*\{?\s*/\* \.MessageID = \*/\s*CFE_SB_MSGID_WRAP_VALUE\((\w+)\)', line)
+        if m:
+            ds_mids.setdefault(ds_mid_value(m.group(1)), []).append((m.group(1), line_num))
+ds_dups = {k: v for k, v in ds_mids.items() if len(v) > 1}
+for mid, uses in ds_dups.items():
+    print('  DS filter table duplicate MID', mid, ':', ', '.join(name + ' (line ' + str(num) + ')' for name, num in uses))
+if ds_dups:
+    print('Invalid DS filter table, each MID may only appear once!')
+    print('Exiting due to error...')
+    sys.exit(1)
+
 # Read number of spacecraft
 mission_number_spacecraft = mission_root.find('number-spacecraft').text
 print('  number-spacecraft:', mission_number_spacecraft)
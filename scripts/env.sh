@@ -50,6 +50,10 @@ INFLUXDB_ADMIN_PASSWORD=admin_password
 
 DBOX="ivvitc/nos3-64:20250217"
 
+# CPUs the NOS Engine server container is pinned to, e.g. "2-3", empty for all CPUs
+NOS_ENGINE_CPUS=${NOS_ENGINE_CPUS:-}
+NOS_ENGINE_FLAGS=${NOS_ENGINE_CPUS:+--cpuset-cpus=$NOS_ENGINE_CPUS}
+
 # Debugging
 #echo "Script directory = " $SCRIPT_DIR
 #echo "Base directory   = " $BASE_DIR
@@ -0,0 +1,196 @@
+#
+# Convenience script for NOS3 development
+# Convert 42 IPC state files to an indexed binary ephemeris for GPS replay
+#   Script assumes run from top level directory of NOS3 repo
+#
+# The "Write to file for analysis" entry in cfg/InOut/Inp_IPC.txt already has
+# 42 write State.42 on every run, with SC[0].PosR and SC[0].VelR relative to
+# the reference orbit and Orb[0].PosN and Orb[0].VelN for the orbit itself.
+# Their sums are the inertial state.  Any other IPC file with PosN/VelN or
+# PosW/VelW lines, such as one holding SC[0].AC.GPS[0], can be read with
+# --prefix and --frame.  This script converts that text into a binary file of
+# fixed size records sorted by time:
+#   header: "NEPH", uint16 version, uint16 record size, uint32 count,
+#           float64 first time, float64 last time, char frame ('N' inertial
+#           or 'W' Earth fixed), 35 spare bytes (64 bytes)
+#   record: float64 time, float64 position x, y, z [m], float64 velocity
+#           x, y, z [m/s] (56 bytes)
+# all little endian.  Times are seconds since 2000-01-01 12:00:00 in the time
+# scale 42 prints (UTC), so leap seconds still have to be applied for GPS time.
+# Because the records are fixed size and sorted, a reader memory maps the file
+# and finds any time with a binary search, then interpolates between the two
+# records around it with a cubic Hermite using both positions and velocities,
+# as the sample command does here.  States can then be produced at any rate,
+# without 42 running.
+#
+# Examples:
+#   python3 ./scripts/gps_ephem.py convert ~/.nos3/42/NOS3InOut/State.42 -o ./sims/build/bin/gps.eph
+#   python3 ./scripts/gps_ephem.py sample ./sims/build/bin/gps.eph --rate 10 --duration 60
+#
+
+import argparse
+import bisect
+import calendar
+import mmap
+import re
+import struct
+import sys
+
+MAGIC = b'NEPH'
+VERSION = 1
+HDR_FMT = '<4sHHIddc35x'
+REC_FMT = '<7d'
+J2000_UNIX = 946728000.0
+TIME_RE = re.compile(r'^TIME\s+(\d+)-(\d+)-(\d+):(\d+):([\d.]+)')
+
+
+def time_42(match):
+    # 42 prints TIME as year-day of year-hh:mm:ss.sss
+    year, doy, hour, minute = (int(match.group(i)) for i in range(1, 5))
+    sec = float(match.group(5))
+    days = calendar.timegm((year, 1, 1, 0, 0, 0)) + (doy - 1) * 86400.0
+    return days + hour * 3600.0 + minute * 60.0 + sec - J2000_UNIX
+
+
+def convert(args):
+    # Each state is the sum of the vectors named in keys, all of which must be present
+    keys = ['%s.Pos%s' % (args.prefix, args.frame), '%s.Vel%s' % (args.prefix, args.frame)]
+    if args.frame == 'R':
+        keys += ['Orb[%d].PosN' % args.orbit, 'Orb[%d].VelN' % args.orbit]
+    records = []
+    cur_time = None
+    vectors = {}
+
+    def flush():
+        if cur_time is not None and all(k in vectors for k in keys):
+            pos = [sum(vectors[k][i] for k in keys[0::2]) for i in range(3)]
+            vel = [sum(vectors[k][i] for k in keys[1::2]) for i in range(3)]
+            records.append(tuple([cur_time] + pos + vel))
+
+    with open(args.state, 'r', errors='replace') as fp:
+        for line in fp:
+            m = TIME_RE.match(line)
+            if m:
+                flush()
+                cur_time, vectors = time_42(m), {}
+                continue
+            if '=' not in line:
+                continue
+            key, _, value = line.partition('=')
+            key = key.strip()
+            if key in keys:
+                vectors[key] = [float(v) for v in value.split()[:3]]
+    flush()
+
+    if len(records) < 2:
+        raise ValueError('found %d states with %s in %s, need at least 2'
+                         % (len(records), ', '.join(keys), args.state))
+    records.sort()
+    unique = [records[0]]
+    for rec in records[1:]:
+        if rec[0] > unique[-1][0]:
+            unique.append(rec)
+
+    with open(args.output, 'wb') as out:
+        frame = b'W' if args.frame == 'W' else b'N'
+        out.write(struct.pack(HDR_FMT, MAGIC, VERSION, struct.calcsize(REC_FMT), len(unique), unique[0][0],
+                              unique[-1][0], frame))
+        for rec in unique:
+            out.write(struct.pack(REC_FMT, *rec))
+    print('  %d states from %.3f to %.3f s written to %s' % (len(unique), unique[0][0], unique[-1][0], args.output))
+
+
+class Ephemeris:
+    def __init__(self, path):
+        self.fp = open(path, 'rb')
+        self.map = mmap.mmap(self.fp.fileno(), 0, access=mmap.ACCESS_READ)
+        magic, version, rec_size, self.count, self.first, self.last, frame = struct.unpack_from(HDR_FMT, self.map, 0)
+        self.frame = frame.decode('ascii', 'replace')
+        if magic != MAGIC or version != VERSION or rec_size != struct.calcsize(REC_FMT):
+            raise ValueError('%s is not a version %d ephemeris file' % (path, VERSION))
+        if len(self.map) < struct.calcsize(HDR_FMT) + self.count * rec_size:
+            raise ValueError('%s is truncated' % path)
+        self.rec_size = rec_size
+        self.times = _TimeView(self)
+
+    def record(self, i):
+        return struct.unpack_from(REC_FMT, self.map, struct.calcsize(HDR_FMT) + i * self.rec_size)
+
+    def state(self, t):
+        # Cubic Hermite between the records that bracket t
+        if t < self.first or t > self.last:
+            raise ValueError('time %.3f is outside %.3f to %.3f' % (t, self.first, self.last))
+        i = min(max(bisect.bisect_right(self.times, t) - 1, 0), self.count - 2)
+        r0, r1 = self.record(i), self.record(i + 1)
+        h = r1[0] - r0[0]
+        s = (t - r0[0]) / h
+        h00, h10, h01, h11 = 2 * s**3 - 3 * s**2 + 1, s**3 - 2 * s**2 + s, -2 * s**3 + 3 * s**2, s**3 - s**2
+        d00, d10, d01, d11 = 6 * s**2 - 6 * s, 3 * s**2 - 4 * s + 1, -6 * s**2 + 6 * s, 3 * s**2 - 2 * s
+        pos = tuple(h00 * r0[1 + k] + h10 * h * r0[4 + k] + h01 * r1[1 + k] + h11 * h * r1[4 + k] for k in range(3))
+        vel = tuple((d00 * r0[1 + k] + d01 * r1[1 + k]) / h + d10 * r0[4 + k] + d11 * r1[4 + k] for k in range(3))
+        return pos, vel
+
+
+class _TimeView:
+    # Sequence of record times read straight from the mapping, so bisect needs no copy
+    def __init__(self, eph):
+        self.eph = eph
+
+    def __len__(self):
+        return self.eph.count
+
+    def __getitem__(self, i):
+        return struct.unpack_from('<d', self.eph.map, struct.calcsize(HDR_FMT) + i * self.eph.rec_size)[0]
+
+
+def sample(args):
+    eph = Ephemeris(args.ephemeris)
+    start = eph.first if args.start is None else args.start
+    end = eph.last if args.duration is None else min(eph.last, start + args.duration)
+    step = 1.0 / args.rate
+    print('time,px,py,pz,vx,vy,vz')
+    n = 0
+    while start + n * step <= end:
+        t = start + n * step
+        pos, vel = eph.state(t)
+        print('%.6f,%.3f,%.3f,%.3f,%.6f,%.6f,%.6f' % ((t,) + pos + vel))
+        n += 1
+
+
+def info(args):
+    eph = Ephemeris(args.ephemeris)
+    span = eph.last - eph.first
+    print('%s: %d %s states, %.3f to %.3f s (%.1f s, %.3f s mean spacing)'
+          % (args.ephemeris, eph.count, 'Earth fixed' if eph.frame == 'W' else 'inertial', eph.first, eph.last, span,
+             span / (eph.count - 1)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Build and read GPS ephemeris files')
+    sub = parser.add_subparsers(dest='cmd', required=True)
+    c = sub.add_parser('convert', help='convert a 42 WRITEFILE state file')
+    c.add_argument('state', help='state file written by 42, e.g. State.42')
+    c.add_argument('-o', '--output', default='gps.eph', help='ephemeris file to write')
+    c.add_argument('--prefix', default='SC[0]', help='state name prefix, e.g. SC[0].AC.GPS[0] for the GPS model')
+    c.add_argument('--frame', default='R', choices=['R', 'N', 'W'],
+                   help='R for PosR/VelR plus the reference orbit, N for PosN/VelN, W for Earth fixed PosW/VelW')
+    c.add_argument('--orbit', type=int, default=0, help='reference orbit of the spacecraft, for --frame R')
+    s = sub.add_parser('sample', help='print interpolated states as CSV')
+    s.add_argument('ephemeris')
+    s.add_argument('--rate', type=float, default=1.0, help='states per second')
+    s.add_argument('--start', type=float, help='first time, default the start of the file')
+    s.add_argument('--duration', type=float, help='seconds to print, default to the end of the file')
+    i = sub.add_parser('info', help='summarize an ephemeris file')
+    i.add_argument('ephemeris')
+    args = parser.parse_args()
+
+    try:
+        {'convert': convert, 'sample': sample, 'info': info}[args.cmd](args)
+    except (OSError, ValueError, struct.error) as err:
+        print(err)
+        print('Exiting due to error...')
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,193 @@
+#
+# Convenience script for NOS3 development
+# Replay stored DS telemetry files to the ground system at a multiple of real time
+#   Script assumes run from top level directory of NOS3 repo
+#
+# Streams the packets of one or more DS files, in file and time order, over UDP
+# to a playback telemetry port.  Sending to a port other than the live telemetry
+# port lets the ground system route the packets to a playback stream, so stored
+# HK never updates the live displays or limits.  The packets themselves are sent
+# as they were recorded, with their original secondary header times.
+#
+# Packets are paced by the gaps between their recorded times divided by --speed,
+# or sent back to back with --speed 0.  A time range can be selected with
+# --start and --end, using the <file>.idx sidecar written by ds_index to
+# seek instead of reading from the start of the file.  With --state, progress is
+# saved as the file and byte offset of the next packet, and an interrupted
+# replay started again with the same --state continues from there.
+#
+# Examples:
+#   python3 ./scripts/gsw/ds_playback.py ./fsw/build/exe/cpu1/data/hk --speed 20
+#   python3 ./scripts/gsw/ds_playback.py hk.ds --start 1400000000 --end 1400000600 --state hk.state
+#
+
+import argparse
+import glob
+import json
+import os
+import socket
+import struct
+import sys
+import time
+
+DS_FILE_HDR_LEN = 140   # cFE file header plus DS file header
+PRI_HDR_LEN = 6
+TLM_HDR_LEN = 12        # primary header plus cFE time
+IDX_MAGIC = b'DSIX'
+IDX_HDR_FMT = '>4sHHII'
+IDX_ENTRY_FMT = '>IHHI'
+STATE_EVERY = 256       # packets between progress saves
+
+
+def list_files(paths):
+    files = []
+    for path in paths:
+        if os.path.isdir(path):
+            files.extend(sorted(glob.glob(os.path.join(path, '*.ds'))))
+        else:
+            files.append(path)
+    return files
+
+
+def index_offset(path, start):
+    # Offset of the last indexed packet before start, since packets ahead of an entry
+    # stamped at start can share its time, or None without an index or such an entry
+    try:
+        with open(path + '.idx', 'rb') as fp:
+            data = fp.read()
+    except OSError:
+        return None
+    hdr_len = struct.calcsize(IDX_HDR_FMT)
+    if len(data) < hdr_len:
+        return None
+    magic, version, _, count, _ = struct.unpack_from(IDX_HDR_FMT, data, 0)
+    if magic != IDX_MAGIC or version != 1:
+        return None
+    offset = None
+    for i in range(count):
+        pos = hdr_len + i * struct.calcsize(IDX_ENTRY_FMT)
+        if pos + struct.calcsize(IDX_ENTRY_FMT) > len(data):
+            break
+        secs, subsecs, _, off = struct.unpack_from(IDX_ENTRY_FMT, data, pos)
+        if secs + subsecs / 65536.0 >= start:
+            break
+        offset = off
+    return offset
+
+
+def packets(fp, offset):
+    # Yield (offset, time, packet) from offset to the end of the file
+    fp.seek(offset)
+    while True:
+        hdr = fp.read(PRI_HDR_LEN)
+        if len(hdr) < PRI_HDR_LEN:
+            return
+        length = struct.unpack('>H', hdr[4:6])[0] + 7
+        body = fp.read(length - PRI_HDR_LEN)
+        if len(body) < length - PRI_HDR_LEN:
+            return
+        pkt = hdr + body
+        pkt_time = None
+        if length >= TLM_HDR_LEN and not (pkt[0] & 0x10):
+            secs, subsecs = struct.unpack('>IH', pkt[6:12])
+            pkt_time = secs + subsecs / 65536.0
+        yield offset, pkt_time, pkt
+        offset += length
+
+
+def load_state(path):
+    if not path or not os.path.isfile(path):
+        return None
+    with open(path, 'r') as fp:
+        return json.load(fp)
+
+
+def save_state(path, state):
+    if not path:
+        return
+    tmp = path + '.tmp'
+    with open(tmp, 'w') as fp:
+        json.dump(state, fp)
+    os.replace(tmp, path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Replay stored DS telemetry to the ground system')
+    parser.add_argument('paths', nargs='+', help='DS files or directories of .ds files')
+    parser.add_argument('--host', default='127.0.0.1', help='ground system host')
+    parser.add_argument('--port', type=int, default=6012, help='ground system playback telemetry UDP port')
+    parser.add_argument('--speed', type=float, default=10.0, help='multiple of real time, 0 to send unpaced')
+    parser.add_argument('--start', type=float, help='first packet time to send, cFE seconds')
+    parser.add_argument('--end', type=float, help='last packet time to send, cFE seconds')
+    parser.add_argument('--header-len', type=int, default=DS_FILE_HDR_LEN, help='file header bytes to skip')
+    parser.add_argument('--state', help='progress file used to resume an interrupted replay')
+    args = parser.parse_args()
+
+    files = list_files(args.paths)
+    if not files:
+        print('No DS files found in %s' % ' '.join(args.paths))
+        print('Exiting due to error...')
+        sys.exit(1)
+
+    state = load_state(args.state)
+    resume = None
+    if state is not None:
+        if state.get('file') in files:
+            files = files[files.index(state['file']):]
+            resume = state['offset']
+            print('  resuming %s at offset %d' % (state['file'], resume))
+        else:
+            print('  %s does not match these files, starting from the beginning' % args.state)
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    dest = (args.host, args.port)
+    sent = sent_bytes = 0
+    wall_start = time.monotonic()
+    first_time = None
+    path = offset = None
+
+    try:
+        for path in files:
+            offset = args.header_len
+            if resume is not None:
+                offset, resume = resume, None
+            elif args.start is not None:
+                indexed = index_offset(path, args.start)
+                if indexed is not None:
+                    offset = indexed
+
+            with open(path, 'rb') as fp:
+                for offset, pkt_time, pkt in packets(fp, offset):
+                    if pkt_time is not None:
+                        if args.start is not None and pkt_time < args.start:
+                            continue
+                        if args.end is not None and pkt_time > args.end:
+                            break
+                        # Pace against the first packet so sleep error does not accumulate
+                        if args.speed > 0:
+                            if first_time is None:
+                                first_time = pkt_time
+                            delay = (pkt_time - first_time) / args.speed - (time.monotonic() - wall_start)
+                            if delay > 0:
+                                time.sleep(delay)
+                    sock.sendto(pkt, dest)
+                    sent += 1
+                    sent_bytes += len(pkt)
+                    if sent % STATE_EVERY == 0:
+                        save_state(args.state, {'file': path, 'offset': offset + len(pkt)})
+            save_state(args.state, {'file': path, 'offset': os.path.getsize(path)})
+    except KeyboardInterrupt:
+        if path is not None:
+            save_state(args.state, {'file': path, 'offset': offset})
+        print('  interrupted, progress saved to %s' % args.state if args.state else '  interrupted')
+        sys.exit(1)
+
+    elapsed = time.monotonic() - wall_start
+    print('  %d packets, %d bytes sent to %s:%d in %.1f s (%.0f B/s)'
+          % (sent, sent_bytes, args.host, args.port, elapsed, sent_bytes / elapsed if elapsed > 0 else 0.0))
+    if args.state and os.path.isfile(args.state):
+        os.remove(args.state)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,114 @@
+#
+# Convenience script for NOS3 development
+# Filter and summarize a directory listing file written by the FM app
+#   Script assumes run from top level directory of NOS3 repo
+#
+# FM's directory listing to file command writes every entry of a directory in
+# one pass, where the directory listing telemetry packet only holds a few.
+# Downlink that file with CF and use this script to select the entries to act on:
+#   python3 ./scripts/gsw/fm_dirlist.py hk_dir.lst -p 'hk*.ds' --older 1400000000
+#   python3 ./scripts/gsw/fm_dirlist.py hk_dir.lst -p '*.ds' --names > delete.txt
+#
+# The file is a cFE file header (big endian), a stats record with the
+# directory name and entry counts, then one record per entry holding the name,
+# size, modify time and, in newer FM versions, the mode.  FM writes the records
+# in the byte order of the flight computer, little endian for NOS3.
+#
+
+import argparse
+import fnmatch
+import struct
+import sys
+
+CFE_FS_HDR_FMT = '>8I32s'
+CFE_FS_CONTENT_TYPE = 0x63464531  # 'cFE1'
+DEFAULT_PATH_LEN = 64             # CFE_MISSION_MAX_PATH_LEN in cfe_mission_cfg.h
+
+
+def cstr(raw):
+    return raw.split(b'\0', 1)[0].decode('ascii', errors='replace')
+
+
+def read_listing(path, path_len, order):
+    with open(path, 'rb') as fp:
+        data = fp.read()
+
+    hdr_len = struct.calcsize(CFE_FS_HDR_FMT)
+    stats_fmt = '%s%dsII' % (order, path_len)
+    if len(data) < hdr_len + struct.calcsize(stats_fmt):
+        raise ValueError('%s is too short to be an FM directory listing' % path)
+    hdr = struct.unpack_from(CFE_FS_HDR_FMT, data, 0)
+    if hdr[0] != CFE_FS_CONTENT_TYPE:
+        raise ValueError('%s does not start with a cFE file header' % path)
+    dir_name, dir_entries, file_entries = struct.unpack_from(stats_fmt, data, hdr_len)
+
+    # Records are name, size and time, with a trailing mode word in newer FM versions
+    body = len(data) - hdr_len - struct.calcsize(stats_fmt)
+    entry_fmt = None
+    for words in (3, 2):
+        fmt = '%s%ds%dI' % (order, path_len, words)
+        if body == file_entries * struct.calcsize(fmt):
+            entry_fmt = fmt
+    if body and entry_fmt is None:
+        raise ValueError('%s holds %d bytes of records, which does not match %d entries of a %d byte path'
+                         % (path, body, file_entries, path_len))
+
+    entries = []
+    offset = len(data) - body
+    for _ in range(file_entries):
+        rec = struct.unpack_from(entry_fmt, data, offset)
+        entries.append((cstr(rec[0]), rec[1], rec[2]))
+        offset += struct.calcsize(entry_fmt)
+    return cstr(hdr[8]), cstr(dir_name), dir_entries, entries
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Filter and summarize an FM directory listing file')
+    parser.add_argument('listing', help='listing file written by the FM directory listing to file command')
+    parser.add_argument('-p', '--pattern', action='append', help='shell pattern to keep, may be repeated')
+    parser.add_argument('--older', type=int, help='keep entries modified before this time in seconds')
+    parser.add_argument('--newer', type=int, help='keep entries modified at or after this time in seconds')
+    parser.add_argument('--min-size', type=int, default=0, help='keep entries of at least this many bytes')
+    parser.add_argument('--names', action='store_true', help='print only the full path of each kept entry')
+    parser.add_argument('--path-len', type=int, default=DEFAULT_PATH_LEN, help='OS_MAX_PATH_LEN of the flight build')
+    parser.add_argument('--big-endian', action='store_true', help='records were written by a big endian target')
+    args = parser.parse_args()
+
+    try:
+        desc, dir_name, dir_entries, entries = read_listing(args.listing, args.path_len,
+                                                            '>' if args.big_endian else '<')
+    except (OSError, ValueError) as err:
+        print(err)
+        print('Exiting due to error...')
+        sys.exit(1)
+
+    kept = []
+    for name, size, mtime in entries:
+        if args.pattern and not any(fnmatch.fnmatchcase(name, p) for p in args.pattern):
+            continue
+        if args.older is not None and mtime >= args.older:
+            continue
+        if args.newer is not None and mtime < args.newer:
+            continue
+        if size < args.min_size:
+            continue
+        kept.append((name, size, mtime))
+
+    base = dir_name.rstrip('/')
+    if args.names:
+        for name, _, _ in kept:
+            print('%s/%s' % (base, name))
+        return
+
+    print('%s: %s, %d entries in directory, %d in file' % (args.listing, dir_name, dir_entries, len(entries)))
+    if desc:
+        print('  %s' % desc)
+    for name, size, mtime in kept:
+        print('  %-48s %12d %12d' % (name, size, mtime))
+    print('  %d entries kept, %d bytes' % (len(kept), sum(e[1] for e in kept)))
+    if dir_entries > len(entries):
+        print('  listing was truncated by FM, %d entries were not written' % (dir_entries - len(entries)))
+
+
+if __name__ == '__main__':
+    main()
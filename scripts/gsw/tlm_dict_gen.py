@@ -0,0 +1,147 @@
+#
+# Convenience script for NOS3 development
+# Generate the packet dictionary used by the ccsds_decoder host tool
+#   Script assumes run from top level directory of NOS3 repo
+#
+# Reads COSMOS telemetry definitions (TELEMETRY, APPEND_ITEM, APPEND_ID_ITEM,
+# APPEND_ARRAY_ITEM, ITEM, ID_ITEM, and render of header partials) and writes
+# one PACKET line per APID followed by a FIELD line per decodable item:
+#   PACKET <apid> <name>
+#   FIELD  <name> <bit offset> <bits> <UINT|INT|FLOAT> <BIG|LITTLE>
+#
+# Example:
+#   python3 ./scripts/gsw/tlm_dict_gen.py -o ./fsw/build/tlm.dict
+#
+
+import argparse
+import glob
+import os
+import re
+import shlex
+import sys
+
+TLM_GLOBS = [
+    './components/*/gsw/**/cmd_tlm/*.txt',
+    './gsw/cosmos/config/targets/**/cmd_tlm/*.txt',
+]
+RENDER_RE = re.compile(r'<%=\s*render\s+["\']([^"\']+)["\'].*?%>')
+STREAMID_ITEMS = ('CCSDS_STREAMID', 'CCSDS_STREAM_ID', 'CCSDS_STREAMID_TLM', 'STREAMID')
+
+
+def expand(path, seen=None):
+    # Inline ERB header partials, which are looked up next to the file and in the parent target
+    seen = seen or set()
+    lines = []
+    with open(path, 'r', errors='replace') as fp:
+        for line in fp:
+            m = RENDER_RE.search(line)
+            if m:
+                for cand in (os.path.join(os.path.dirname(path), m.group(1)),
+                             os.path.join(os.path.dirname(os.path.dirname(path)), m.group(1))):
+                    if os.path.isfile(cand) and cand not in seen:
+                        seen.add(cand)
+                        lines.extend(expand(cand, seen))
+                        break
+                continue
+            lines.append(line)
+    return lines
+
+
+def endian_of(tokens, default):
+    for tok in tokens:
+        if tok in ('BIG_ENDIAN', 'LITTLE_ENDIAN'):
+            return tok.split('_')[0]
+    return default
+
+
+def parse(path, packets):
+    current = None
+    for line in expand(path):
+        line = line.strip()
+        if not line or line.startswith('#'):
+            continue
+        try:
+            tok = shlex.split(line)
+        except ValueError:
+            tok = line.split()
+        key = tok[0].upper()
+
+        if key == 'TELEMETRY' and len(tok) >= 4:
+            current = {'name': tok[2], 'endian': tok[3].split('_')[0], 'offset': 0, 'apid': None, 'fields': []}
+            packets.append(current)
+            continue
+        if current is None:
+            continue
+
+        if key in ('APPEND_ITEM', 'APPEND_ID_ITEM') and len(tok) >= 4:
+            name, bits, ftype = tok[1], int(tok[2]), tok[3].upper()
+            offset = current['offset']
+            current['offset'] += max(bits, 0)
+            id_value = tok[4] if key == 'APPEND_ID_ITEM' and len(tok) > 4 else None
+        elif key in ('ITEM', 'ID_ITEM') and len(tok) >= 5:
+            name, offset, bits, ftype = tok[1], int(tok[2]), int(tok[3]), tok[4].upper()
+            id_value = tok[5] if key == 'ID_ITEM' and len(tok) > 5 else None
+            if offset < 0:
+                continue
+        elif key == 'APPEND_ARRAY_ITEM' and len(tok) >= 5:
+            current['offset'] += max(int(tok[4]), 0)
+            continue
+        elif key in ('TELEMETRY', 'COMMAND'):
+            current = None
+            continue
+        else:
+            continue
+
+        if id_value is not None and name.upper() in STREAMID_ITEMS:
+            current['apid'] = int(id_value, 0) & 0x7FF
+        if ftype not in ('UINT', 'INT', 'FLOAT') or bits <= 0 or bits > 64:
+            continue
+        if ftype == 'FLOAT' and bits not in (32, 64):
+            continue
+        current['fields'].append((name, offset, bits, ftype, endian_of(tok[4:], current['endian'])))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate the ccsds_decoder packet dictionary')
+    parser.add_argument('paths', nargs='*', help='telemetry definition files or directories')
+    parser.add_argument('-o', '--output', default='tlm.dict', help='dictionary file to write')
+    args = parser.parse_args()
+
+    files = []
+    for path in args.paths:
+        if os.path.isdir(path):
+            files.extend(sorted(glob.glob(os.path.join(path, '**', '*.txt'), recursive=True)))
+        else:
+            files.append(path)
+    if not args.paths:
+        for pattern in TLM_GLOBS:
+            files.extend(sorted(glob.glob(pattern, recursive=True)))
+    if not files:
+        print('No telemetry definitions found, are the components and gsw checked out?')
+        print('Exiting due to error...')
+        sys.exit(1)
+
+    packets = []
+    for path in files:
+        parse(path, packets)
+
+    written = 0
+    apids = set()
+    with open(args.output, 'w') as out:
+        out.write('# Generated by scripts/gsw/tlm_dict_gen.py from %d telemetry definition files\n' % len(files))
+        for pkt in packets:
+            if pkt['apid'] is None:
+                continue
+            if pkt['apid'] in apids:
+                print('  duplicate APID 0x%03x, keeping first definition and skipping %s' % (pkt['apid'], pkt['name']))
+                continue
+            apids.add(pkt['apid'])
+            out.write('PACKET 0x%03x %s\n' % (pkt['apid'], pkt['name']))
+            for name, offset, bits, ftype, endian in pkt['fields']:
+                out.write('FIELD %s %d %d %s %s\n' % (name, offset, bits, ftype, endian))
+            written += 1
+    print('  %d packets written to %s' % (written, args.output))
+
+
+if __name__ == '__main__':
+    main()
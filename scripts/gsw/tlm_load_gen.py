@@ -0,0 +1,403 @@
+#
+# Convenience script for NOS3 development
+# Synthetic telemetry load generator for ground software stress testing
+#   Script assumes run from top level directory of NOS3 repo
+#
+# Reads the telemetry MIDs routed by TO from cfg/nos3_defs/tables/to_config.c,
+# resolves them through the *_msgids.h headers, and emits CCSDS space packets or
+# TM transfer frames for N virtual spacecraft over UDP, the same way the radio
+# simulator forwards telemetry to the ground.
+#
+# Each packet carries its send time twice: in the cFE secondary header time field
+# and as nanoseconds since the UNIX epoch in the first 8 bytes of user data.  When
+# the ground system is set up to route received telemetry back out (COSMOS router,
+# YAMCS UDP TM link, etc.) to --listen-port, the ingest lag of every returned
+# packet is measured and logged.
+#
+# Examples:
+#   python3 ./scripts/gsw/tlm_load_gen.py --host cosmos --port 6011 --spacecraft 4 --rate 500
+#   python3 ./scripts/gsw/tlm_load_gen.py --format tf --frame-len 1115 --ramp 100:5000:100:10
+#
+
+import argparse
+import csv
+import glob
+import multiprocessing
+import os
+import re
+import select
+import socket
+import struct
+import sys
+import time
+
+TO_CONFIG = './cfg/nos3_defs/tables/to_config.c'
+MSGID_GLOBS = [
+    './cfg/nos3_defs/*.h',
+    './fsw/apps/*/fsw/platform_inc/*msgids.h',
+    './fsw/apps/*/config/*msgids.h',
+    './fsw/cfe/modules/*/config/*msgids.h',
+    './components/*/fsw/cfs/platform_inc/*msgids.h',
+    './components/*/fsw/platform_inc/*msgids.h',
+]
+
+CFE_EPOCH_OFFSET = 946684800  # 2000-01-01 (CFE_MISSION_TIME_EPOCH_YEAR) in UNIX seconds
+PRI_HDR_LEN = 6
+SEC_HDR_LEN = 6
+STAMP_LEN = 8
+MIN_PKT_LEN = PRI_HDR_LEN + SEC_HDR_LEN + STAMP_LEN
+IDLE_APID = 0x7FF
+NO_FIRST_HDR = 0x7FF
+TF_SEG_LEN_ID = 0x1800  # data field status segment length ID '11', required when sync flag is 0
+TF_HDR_LEN = 6
+TF_FECF_LEN = 2
+
+DEFINE_RE = re.compile(r'^\s*#\s*define\s+(\w+)\s+(.+?)\s*(?:/\*.*)?(?://.*)?$')
+TO_ENTRY_RE = re.compile(r'^\s*\{\s*CFE_SB_MSGID_WRAP_VALUE\((\w+)\)')
+TOKEN_RE = re.compile(r'0[xX][0-9a-fA-F]+|\d+|\w+|<<|>>|[-+|&()~]')
+
+
+def read_defines(paths):
+    defines = {}
+    for path in paths:
+        try:
+            with open(path, 'r', errors='replace') as fp:
+                for line in fp:
+                    m = DEFINE_RE.match(line)
+                    if m:
+                        defines.setdefault(m.group(1), m.group(2))
+        except OSError:
+            pass
+    return defines
+
+
+def resolve(name, defines, depth=0):
+    # Evaluate a simple integer macro expression (+, -, |, &, <<, >>, ~, parens)
+    if depth > 16 or name not in defines:
+        return None
+    out = []
+    for tok in TOKEN_RE.findall(defines[name]):
+        if tok[0].isdigit():
+            out.append(str(int(tok, 0)))
+        elif tok[0].isalpha() or tok[0] == '_':
+            if tok in ('CFE_SB_MSGID_WRAP_VALUE', 'CFE_SB_ValueToMsgId'):
+                continue
+            val = resolve(tok, defines, depth + 1)
+            if val is None:
+                return None
+            out.append(str(val))
+        else:
+            out.append(tok)
+    try:
+        return int(eval(' '.join(out), {'__builtins__': {}}))
+    except Exception:
+        return None
+
+
+def load_mids(to_config, extra_includes):
+    paths = [to_config]
+    for pattern in MSGID_GLOBS:
+        paths.extend(sorted(glob.glob(pattern)))
+    for inc in extra_includes:
+        paths.extend(sorted(glob.glob(os.path.join(inc, '*.h'))))
+    defines = read_defines(paths)
+
+    mids = []
+    unresolved = []
+    with open(to_config, 'r') as fp:
+        for line in fp:
+            if line.lstrip().startswith('//'):
+                continue
+            m = TO_ENTRY_RE.match(line)
+            if not m or m.group(1) == 'TO_UNUSED_ENTRY':
+                continue
+            value = resolve(m.group(1), defines)
+            if value is None:
+                unresolved.append(m.group(1))
+            elif (value & 0x1000) == 0:
+                mids.append((m.group(1), value))
+    return mids, unresolved
+
+
+def load_lengths(path):
+    # CSV of "MID name or value, total packet length in bytes"
+    lengths = {}
+    if path:
+        with open(path, 'r') as fp:
+            for row in csv.reader(fp):
+                if len(row) >= 2 and not row[0].startswith('#'):
+                    lengths[row[0].strip()] = int(row[1], 0)
+    return lengths
+
+
+def crc16_ccitt(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+class Spacecraft:
+    def __init__(self, index, args, mids, lengths):
+        self.scid = args.scid + index
+        self.dest = (args.host, args.port + index * args.port_stride)
+        self.mids = mids
+        self.lengths = lengths
+        self.default_len = max(args.length, MIN_PKT_LEN)
+        self.seq = {}
+        self.next_mid = 0
+        self.mc_count = 0
+        self.vc_count = 0
+        self.frame_len = args.frame_len
+        self.fecf = args.fecf
+        self.pending = bytearray()
+        self.pending_hdrs = []
+
+    def packet(self, now_ns):
+        name, mid = self.mids[self.next_mid]
+        self.next_mid = (self.next_mid + 1) % len(self.mids)
+        length = self.lengths.get(name, self.lengths.get(hex(mid), self.default_len))
+        length = max(length, MIN_PKT_LEN)
+        apid = mid & 0x07FF
+        seq = self.seq.get(apid, 0)
+        self.seq[apid] = (seq + 1) & 0x3FFF
+
+        secs = now_ns // 1000000000
+        subs = ((now_ns % 1000000000) << 16) // 1000000000
+        hdr = struct.pack('>HHHIHQ', 0x0800 | apid, 0xC000 | seq, length - 7,
+                          (secs - CFE_EPOCH_OFFSET) & 0xFFFFFFFF, subs, now_ns)
+        fill = length - len(hdr)
+        return hdr + bytes((self.scid + i) & 0xFF for i in range(fill))
+
+    def frames(self, pkt):
+        # Pack packets into fixed length TM transfer frames, spanning as needed.  The
+        # first header pointer is the offset of the first packet that starts in the
+        # frame, or NO_FIRST_HDR when the frame only continues an earlier packet.
+        data_len = self.frame_len - TF_HDR_LEN - (TF_FECF_LEN if self.fecf else 0)
+        self.pending_hdrs.append(len(self.pending))
+        self.pending += pkt
+        out = []
+        while len(self.pending) >= data_len:
+            first_hdr = self.pending_hdrs[0] if self.pending_hdrs and self.pending_hdrs[0] < data_len else NO_FIRST_HDR
+            out.append(self.frame(self.pending[:data_len], first_hdr))
+            self.pending = self.pending[data_len:]
+            self.pending_hdrs = [off - data_len for off in self.pending_hdrs if off >= data_len]
+        return out
+
+    def flush_frame(self):
+        # Complete a partial frame with an idle packet so nothing waits on the next packet.
+        # An idle packet too short to fit spans into a second frame, and both are returned.
+        data_len = self.frame_len - TF_HDR_LEN - (TF_FECF_LEN if self.fecf else 0)
+        if not self.pending:
+            return []
+        fill = data_len - len(self.pending)
+        if fill < PRI_HDR_LEN + 1:
+            fill += data_len
+        idle = struct.pack('>HHH', IDLE_APID, 0xC000, fill - 7) + bytes(fill - PRI_HDR_LEN)
+        return self.frames(idle)
+
+    def frame(self, data, first_hdr):
+        hdr = struct.pack('>HBBH', (self.scid & 0x3FF) << 4, self.mc_count, self.vc_count,
+                          TF_SEG_LEN_ID | (first_hdr & 0x7FF))
+        self.mc_count = (self.mc_count + 1) & 0xFF
+        self.vc_count = (self.vc_count + 1) & 0xFF
+        frame = hdr + bytes(data)
+        if self.fecf:
+            frame += struct.pack('>H', crc16_ccitt(frame))
+        return frame
+
+
+def parse_ramp(ramp):
+    # start:stop:step:seconds-per-step
+    start, stop, step, dwell = [float(x) for x in ramp.split(':')]
+    rates = []
+    rate = start
+    while rate <= stop:
+        rates.append((rate, dwell))
+        rate += step
+    return rates
+
+
+def worker(worker_id, sc_indices, args, mids, lengths, schedule, queue):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_SNDBUF, 4 * 1024 * 1024)
+    craft = [Spacecraft(i, args, mids, lengths) for i in sc_indices]
+
+    for step, (rate, dwell) in enumerate(schedule):
+        period = 1.0 / rate
+        start = time.perf_counter()
+        end = start + dwell
+        next_send = start
+        sent = 0
+        sent_bytes = 0
+        errors = 0
+        max_behind = 0.0
+        while True:
+            now = time.perf_counter()
+            if now >= end:
+                break
+            if now < next_send:
+                time.sleep(min(next_send - now, 0.001))
+                continue
+            max_behind = max(max_behind, now - next_send)
+            now_ns = time.time_ns()
+            for sc in craft:
+                pkt = sc.packet(now_ns)
+                datagrams = [pkt] if args.format == 'ccsds' else sc.frames(pkt)
+                if args.format == 'tf' and args.flush:
+                    datagrams.extend(sc.flush_frame())
+                for dgram in datagrams:
+                    try:
+                        sock.sendto(dgram, sc.dest)
+                        sent_bytes += len(dgram)
+                    except OSError:
+                        errors += 1
+                sent += 1
+            next_send += period
+        elapsed = time.perf_counter() - start
+        queue.put((worker_id, step, rate, len(craft), sent, sent_bytes, errors, elapsed, max_behind))
+    queue.put((worker_id, None))
+
+
+def listener(args, stop_time, queue):
+    # Measure ingest lag from telemetry the ground system routes back out, which is
+    # expected as space packets (one or more per datagram) whatever --format was sent
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(('0.0.0.0', args.listen_port))
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 8 * 1024 * 1024)
+    lags = []
+    interval_end = time.time() + 1.0
+    while time.time() < stop_time:
+        ready, _, _ = select.select([sock], [], [], 0.1)
+        if ready:
+            data, _ = sock.recvfrom(65536)
+            now_ns = time.time_ns()
+            offset = 0
+            while offset + MIN_PKT_LEN <= len(data):
+                apid, _, plen = struct.unpack_from('>HHH', data, offset)
+                if (apid & 0x07FF) != IDLE_APID:
+                    sent_ns = struct.unpack_from('>Q', data, offset + PRI_HDR_LEN + SEC_HDR_LEN)[0]
+                    if 0 < sent_ns <= now_ns:
+                        lags.append((sent_ns, (now_ns - sent_ns) / 1e6))
+                offset += plen + 7
+        if time.time() >= interval_end and lags:
+            queue.put(('lag', lags))
+            lags = []
+            interval_end = time.time() + 1.0
+    queue.put(('lag', lags))
+    queue.put(('lag', None))
+
+
+def percentile(values, pct):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * pct / 100.0))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='NOS3 synthetic telemetry load generator')
+    parser.add_argument('--host', default='127.0.0.1', help='ground system or radio sim telemetry host')
+    parser.add_argument('--port', type=int, default=6011, help='telemetry UDP port of the first spacecraft')
+    parser.add_argument('--port-stride', type=int, default=0, help='port increment per virtual spacecraft')
+    parser.add_argument('--spacecraft', type=int, default=1, help='number of virtual spacecraft')
+    parser.add_argument('--scid', type=int, default=42, help='spacecraft id of the first virtual spacecraft')
+    parser.add_argument('--rate', type=float, default=100.0, help='packets per second per spacecraft')
+    parser.add_argument('--duration', type=float, default=60.0, help='seconds to run at --rate')
+    parser.add_argument('--ramp', help='start:stop:step:seconds, step the rate to find the breaking point')
+    parser.add_argument('--format', choices=['ccsds', 'tf'], default='ccsds', help='space packets or TM transfer frames')
+    parser.add_argument('--frame-len', type=int, default=1115, help='TM transfer frame length in bytes')
+    parser.add_argument('--fecf', action='store_true', help='append a frame error control field to each frame')
+    parser.add_argument('--flush', action='store_true', help='idle fill each frame instead of spanning packets')
+    parser.add_argument('--length', type=int, default=64, help='default packet length in bytes')
+    parser.add_argument('--lengths', help='CSV of MID name or hex value and packet length')
+    parser.add_argument('--include', action='append', default=[], help='extra directory of *_msgids.h headers')
+    parser.add_argument('--to-config', default=TO_CONFIG, help='TO configuration table source')
+    parser.add_argument('--workers', type=int, default=1, help='sender processes, spacecraft are divided among them')
+    parser.add_argument('--listen-port', type=int, default=0, help='UDP port for telemetry routed back by the ground')
+    parser.add_argument('--log', default='load_gen.csv', help='CSV results file')
+    args = parser.parse_args()
+
+    mids, unresolved = load_mids(args.to_config, args.include)
+    if unresolved:
+        print('  unresolved MIDs (headers not checked out?):', ' '.join(unresolved))
+    if not mids:
+        print('No telemetry MIDs resolved from', args.to_config)
+        print('Exiting due to error...')
+        sys.exit(1)
+    print('  telemetry MIDs:', len(mids))
+    lengths = load_lengths(args.lengths)
+
+    schedule = parse_ramp(args.ramp) if args.ramp else [(args.rate, args.duration)]
+    total_time = sum(dwell for _, dwell in schedule)
+    workers = max(1, min(args.workers, args.spacecraft))
+    queue = multiprocessing.Queue()
+
+    procs = []
+    for w in range(workers):
+        indices = list(range(w, args.spacecraft, workers))
+        procs.append(multiprocessing.Process(target=worker, args=(w, indices, args, mids, lengths, schedule, queue)))
+    if args.listen_port:
+        procs.append(multiprocessing.Process(target=listener, args=(args, time.time() + total_time + 2.0, queue)))
+    for p in procs:
+        p.start()
+
+    # Lag samples are assigned to ramp steps by their send time once everything has returned
+    start_ns = time.time_ns()
+    steps = {}
+    lags = []
+    done = 0
+    while done < len(procs):
+        msg = queue.get()
+        if msg[0] == 'lag':
+            if msg[1] is None:
+                done += 1
+            else:
+                lags.extend(msg[1])
+        elif msg[1] is None:
+            done += 1
+        else:
+            _, step, rate, ncraft, sent, nbytes, errors, elapsed, behind = msg
+            acc = steps.setdefault(step, [rate, 0, 0, 0, 0, 0.0, 0.0])
+            acc[1] += ncraft
+            acc[2] += sent
+            acc[3] += nbytes
+            acc[4] += errors
+            acc[5] = max(acc[5], elapsed)
+            acc[6] = max(acc[6], behind)
+    for p in procs:
+        p.join()
+
+    bounds = []
+    t = start_ns
+    for _, dwell in schedule:
+        t += int(dwell * 1e9)
+        bounds.append(t)
+    step_lags = [[] for _ in schedule]
+    for sent_ns, lag in lags:
+        step = next((i for i, b in enumerate(bounds) if sent_ns < b), len(bounds) - 1)
+        step_lags[step].append(lag)
+
+    with open(args.log, 'w', newline='') as fp:
+        out = csv.writer(fp)
+        out.writerow(['rate_per_sc', 'spacecraft', 'offered_pps', 'achieved_pps', 'bytes_per_s',
+                      'send_errors', 'max_sched_lag_ms', 'lag_samples', 'lag_p50_ms', 'lag_p99_ms', 'lag_max_ms'])
+        for step in sorted(steps):
+            rate, _, sent, nbytes, errors, elapsed, behind = steps[step]
+            step_lag = step_lags[step]
+            achieved = sent / elapsed if elapsed > 0 else 0.0
+            row = [rate, args.spacecraft, rate * args.spacecraft, round(achieved, 1),
+                   round(nbytes / elapsed, 1) if elapsed > 0 else 0, errors, round(behind * 1000.0, 3),
+                   len(step_lag), round(percentile(step_lag, 50), 3), round(percentile(step_lag, 99), 3),
+                   round(max(step_lag) if step_lag else 0.0, 3)]
+            out.writerow(row)
+            print('  rate %8.1f x %d sc: achieved %10.1f pkt/s, lag p50 %.3f ms p99 %.3f ms (%d samples)'
+                  % (rate, args.spacecraft, achieved, row[8], row[9], len(step_lag)))
+    print('Results written to', args.log)
+
+
+if __name__ == '__main__':
+    main()
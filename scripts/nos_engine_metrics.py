@@ -0,0 +1,215 @@
+#
+# Convenience script for NOS3 development
+# Per node traffic metrics for the NOS Engine server
+#   Script assumes run from top level directory of NOS3 repo
+#
+# Every simulator and core-cpu1 holds one TCP connection to the NOS Engine
+# server for each server URI it uses (12000 for fsw, 12001 for nos3), so the
+# kernel's counters for those connections give each node's traffic without any
+# change to the server.  Each interval the script samples them with `ss` inside
+# the server container and reports, per connection, node and server URI:
+#   bytes/s to and from the server, data segments/s (about one per bus
+#   transaction for small transfers), and the smoothed TCP round trip time
+# Round trip times are also kept in a cumulative histogram per server URI.
+#
+# Results can be appended as one JSON object per interval (--json) and served
+# as Prometheus text on http://<host>:<port>/metrics (--http-port), which can
+# be queried live with curl while the simulation runs.
+#
+# Examples:
+#   python3 ./scripts/nos_engine_metrics.py --container sc_1_nos_engine_server --interval 5
+#   python3 ./scripts/nos_engine_metrics.py --network nos3_sc_1 --json metrics.jsonl --http-port 9105
+#
+
+import argparse
+import http.server
+import json
+import re
+import subprocess
+import sys
+import threading
+import time
+
+SERVER_PORTS = {12000: 'fsw', 12001: 'nos3'}
+RTT_BUCKETS_MS = [0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 25.0, 50.0, 100.0]
+COUNTERS = ('bytes_acked', 'bytes_received', 'data_segs_out', 'data_segs_in')
+
+latest_metrics = ''
+metrics_lock = threading.Lock()
+
+
+def split_addr(addr):
+    host, _, port = addr.rpartition(':')
+    return host.strip('[]'), int(port)
+
+
+def sample(args):
+    # Return {(local port, peer address): {counter: value, 'rtt': ms}} for established server connections
+    filt = ' or '.join('sport = :%d' % p for p in SERVER_PORTS)
+    cmd = ['ss', '-tinH', 'state', 'established', '( %s )' % filt]
+    if args.container:
+        cmd = [args.docker, 'exec', args.container] + cmd
+    out = subprocess.run(cmd, capture_output=True, text=True, check=True).stdout
+
+    # ss prints the connection and then its tcp_info on an indented continuation line
+    records = []
+    for line in out.splitlines():
+        if line[:1] in (' ', '\t') and records:
+            records[-1] += ' ' + line.strip()
+        elif line.strip():
+            records.append(line.strip())
+
+    conns = {}
+    for rec in records:
+        fields = rec.split()
+        if len(fields) < 4:
+            continue
+        _, local_port = split_addr(fields[2])
+        stats = {name: int(m.group(1)) for name in COUNTERS
+                 for m in [re.search(r'\b%s:(\d+)' % name, rec)] if m}
+        m = re.search(r'\brtt:([\d.]+)/', rec)
+        stats['rtt'] = float(m.group(1)) if m else None
+        conns[(local_port, fields[3])] = stats
+    return conns
+
+
+def resolve_names(args):
+    # Map container IP addresses on the spacecraft network to container names
+    if not args.network:
+        return {}
+    try:
+        out = subprocess.run([args.docker, 'network', 'inspect', args.network], capture_output=True, text=True,
+                             check=True).stdout
+        containers = json.loads(out)[0].get('Containers', {})
+    except (OSError, subprocess.CalledProcessError, ValueError, IndexError):
+        print('  unable to inspect network %s, reporting nodes by address' % args.network)
+        return {}
+    return {c['IPv4Address'].split('/')[0]: c['Name'] for c in containers.values()}
+
+
+def prometheus(report, hist):
+    lines = []
+    metric_help = {
+        'nos_engine_node_tx_bytes_per_second': 'bytes per second sent by the server to the node',
+        'nos_engine_node_rx_bytes_per_second': 'bytes per second received by the server from the node',
+        'nos_engine_node_tx_segments_per_second': 'data segments per second sent to the node',
+        'nos_engine_node_rx_segments_per_second': 'data segments per second received from the node',
+        'nos_engine_node_rtt_ms': 'smoothed TCP round trip time to the node',
+    }
+    keys = ['tx_bytes_per_s', 'rx_bytes_per_s', 'tx_segs_per_s', 'rx_segs_per_s', 'rtt_ms']
+    for (name, text), key in zip(metric_help.items(), keys):
+        lines.append('# HELP %s %s' % (name, text))
+        lines.append('# TYPE %s gauge' % name)
+        for conn in report['connections']:
+            if conn[key] is not None:
+                lines.append('%s{uri="%s",node="%s"} %g' % (name, conn['uri'], conn['node'], conn[key]))
+    lines.append('# HELP nos_engine_rtt_ms TCP round trip time samples per server URI')
+    lines.append('# TYPE nos_engine_rtt_ms histogram')
+    for uri, h in sorted(hist.items()):
+        for bound, count in zip(RTT_BUCKETS_MS + ['+Inf'], h['buckets']):
+            lines.append('nos_engine_rtt_ms_bucket{uri="%s",le="%s"} %d' % (uri, bound, count))
+        lines.append('nos_engine_rtt_ms_sum{uri="%s"} %g' % (uri, h['sum']))
+        lines.append('nos_engine_rtt_ms_count{uri="%s"} %d' % (uri, h['count']))
+    return '\n'.join(lines) + '\n'
+
+
+class MetricsHandler(http.server.BaseHTTPRequestHandler):
+    def do_GET(self):
+        if self.path.rstrip('/') not in ('', '/metrics'):
+            self.send_error(404)
+            return
+        with metrics_lock:
+            body = latest_metrics.encode()
+        self.send_response(200)
+        self.send_header('Content-Type', 'text/plain; version=0.0.4')
+        self.send_header('Content-Length', str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def log_message(self, *args):
+        pass
+
+
+def main():
+    global latest_metrics
+    parser = argparse.ArgumentParser(description='Per node traffic metrics for the NOS Engine server')
+    parser.add_argument('--container', default='sc_1_nos_engine_server', help='server container, empty to run ss locally')
+    parser.add_argument('--docker', default='docker', help='container runtime command')
+    parser.add_argument('--network', help='spacecraft network used to name nodes, e.g. nos3_sc_1')
+    parser.add_argument('--interval', type=float, default=5.0, help='seconds between samples')
+    parser.add_argument('--count', type=int, default=0, help='intervals to run, 0 to run until interrupted')
+    parser.add_argument('--json', help='append one JSON object per interval to this file')
+    parser.add_argument('--http-port', type=int, default=0, help='serve Prometheus text on this port')
+    parser.add_argument('--quiet', action='store_true', help='do not print the per interval table')
+    args = parser.parse_args()
+
+    names = resolve_names(args)
+    hist = {}
+    if args.http_port:
+        server = http.server.ThreadingHTTPServer(('0.0.0.0', args.http_port), MetricsHandler)
+        threading.Thread(target=server.serve_forever, daemon=True).start()
+
+    try:
+        prev, prev_time = sample(args), time.monotonic()
+    except (OSError, subprocess.CalledProcessError) as err:
+        print('Unable to sample server connections: %s' % err)
+        print('Exiting due to error...')
+        sys.exit(1)
+
+    intervals = 0
+    try:
+        while args.count == 0 or intervals < args.count:
+            time.sleep(args.interval)
+            try:
+                cur, now = sample(args), time.monotonic()
+            except (OSError, subprocess.CalledProcessError) as err:
+                print('  sample failed: %s' % err)
+                continue
+            dt = now - prev_time
+            report = {'time': time.time(), 'interval': dt, 'connections': []}
+            for key, stats in sorted(cur.items()):
+                local_port, peer = key
+                old = prev.get(key, {})
+                rate = lambda name: (stats.get(name, 0) - old.get(name, 0)) / dt if name in old else None
+                uri = SERVER_PORTS.get(local_port, str(local_port))
+                conn = {
+                    'uri': uri,
+                    'peer': peer,
+                    'node': names.get(split_addr(peer)[0], peer),
+                    'tx_bytes_per_s': rate('bytes_acked'),
+                    'rx_bytes_per_s': rate('bytes_received'),
+                    'tx_segs_per_s': rate('data_segs_out'),
+                    'rx_segs_per_s': rate('data_segs_in'),
+                    'rtt_ms': stats['rtt'],
+                }
+                report['connections'].append(conn)
+                if stats['rtt'] is not None:
+                    h = hist.setdefault(uri, {'buckets': [0] * (len(RTT_BUCKETS_MS) + 1), 'sum': 0.0, 'count': 0})
+                    for i, bound in enumerate(RTT_BUCKETS_MS + [float('inf')]):
+                        if stats['rtt'] <= bound:
+                            h['buckets'][i] += 1
+                    h['sum'] += stats['rtt']
+                    h['count'] += 1
+            report['rtt_histogram_ms'] = {'bounds': RTT_BUCKETS_MS, 'per_uri': hist}
+            prev, prev_time = cur, now
+            intervals += 1
+
+            with metrics_lock:
+                latest_metrics = prometheus(report, hist)
+            if args.json:
+                with open(args.json, 'a') as fp:
+                    fp.write(json.dumps(report) + '\n')
+            if not args.quiet:
+                print('%-5s %-32s %12s %12s %9s %9s %8s' % ('uri', 'node', 'tx B/s', 'rx B/s', 'tx seg/s', 'rx seg/s', 'rtt ms'))
+                for c in sorted(report['connections'], key=lambda c: -(c['rx_bytes_per_s'] or 0)):
+                    fmt = lambda v, f: f % v if v is not None else '-'
+                    print('%-5s %-32s %12s %12s %9s %9s %8s' % (c['uri'], c['node'][:32],
+                          fmt(c['tx_bytes_per_s'], '%.0f'), fmt(c['rx_bytes_per_s'], '%.0f'),
+                          fmt(c['tx_segs_per_s'], '%.1f'), fmt(c['rx_segs_per_s'], '%.1f'), fmt(c['rtt_ms'], '%.3f')))
+                print('')
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,337 @@
+/* Copyright (C) 2009 - 2025 National Aeronautics and Space Administration. All Foreign Rights are Reserved to the U.S. Government.
+
+   This software is provided "as is" without any warranty of any kind, either expressed, implied, or statutory, including, but not
+   limited to, any warranty that the software will conform to specifications, any implied warranties of merchantability, fitness
+   for a particular purpose, and freedom from infringement, and any warranty that the documentation will conform to the program, or
+   any warranty that the software will be error free.
+
+   In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or consequential damages,
+   arising out of, resulting from, or in any way connected with the software or its documentation, whether or not based upon warranty,
+   contract, tort or otherwise, and whether or not the loss was sustained from, or arose out of the results of, or use of, the software,
+   documentation or services provided hereunder.
+
+   ITC Team
+   NASA IV&V
+   ivv-itc@lists.nasa.gov
+*/
+
+/*
+** Measures the round trip latency of one bus sized transaction between two
+** processes on the same host, over TCP loopback (the path every NOS Engine
+** node takes today) and over a pair of shared memory rings (the path a same
+** host shm:// transport would take).  The peer process echoes each request,
+** the way a simulator answers an FSW read.
+**
+** A NOS Engine transaction crosses the server, so it costs two of these hops
+** each way.  The difference per hop is what a shared memory transport saves.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <linux/futex.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    const uint32_t RING_SLOTS = 64;
+    const uint32_t SLOT_BYTES = 4096;
+    const int      SPIN_YIELDS = 100;
+
+    struct Options
+    {
+        std::string mode = "both";
+        size_t      size = 16;
+        long        count = 100000;
+        long        warmup = 1000;
+        int         cpu_client = -1;
+        int         cpu_peer = -1;
+    };
+
+    /* Single producer, single consumer ring.  The consumer yields a few times and then sleeps on a futex. */
+    struct Ring
+    {
+        alignas(64) std::atomic<uint32_t> head;
+        alignas(64) std::atomic<uint32_t> tail;
+        alignas(64) std::atomic<uint32_t> waiting;
+        uint32_t length[RING_SLOTS];
+        uint8_t  data[RING_SLOTS][SLOT_BYTES];
+    };
+
+    struct SharedLink
+    {
+        Ring request;
+        Ring reply;
+    };
+
+    void futex_wait(std::atomic<uint32_t>* word, uint32_t expected)
+    {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+    }
+
+    void futex_wake(std::atomic<uint32_t>* word)
+    {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+    }
+
+    void ring_push(Ring& ring, const uint8_t* data, uint32_t length)
+    {
+        uint32_t head = ring.head.load(std::memory_order_relaxed);
+        while (head - ring.tail.load(std::memory_order_acquire) == RING_SLOTS)
+        {
+            sched_yield();
+        }
+        memcpy(ring.data[head % RING_SLOTS], data, length);
+        ring.length[head % RING_SLOTS] = length;
+        ring.head.store(head + 1, std::memory_order_seq_cst);
+        if (ring.waiting.load(std::memory_order_seq_cst) != 0)
+        {
+            futex_wake(&ring.head);
+        }
+    }
+
+    uint32_t ring_pop(Ring& ring, uint8_t* data)
+    {
+        uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+        int      spins = 0;
+        while (ring.head.load(std::memory_order_acquire) == tail)
+        {
+            if (++spins < SPIN_YIELDS)
+            {
+                sched_yield();
+                continue;
+            }
+            ring.waiting.store(1, std::memory_order_seq_cst);
+            if (ring.head.load(std::memory_order_seq_cst) == tail)
+            {
+                futex_wait(&ring.head, tail);
+            }
+            ring.waiting.store(0, std::memory_order_relaxed);
+        }
+        uint32_t length = ring.length[tail % RING_SLOTS];
+        memcpy(data, ring.data[tail % RING_SLOTS], length);
+        ring.tail.store(tail + 1, std::memory_order_release);
+        return length;
+    }
+
+    void pin(int cpu)
+    {
+        if (cpu < 0)
+        {
+            return;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0)
+        {
+            fprintf(stderr, "Unable to pin to cpu %d\n", cpu);
+        }
+    }
+
+    bool read_full(int fd, uint8_t* data, size_t length)
+    {
+        while (length > 0)
+        {
+            ssize_t got = recv(fd, data, length, 0);
+            if (got <= 0)
+            {
+                return false;
+            }
+            data += got;
+            length -= static_cast<size_t>(got);
+        }
+        return true;
+    }
+
+    void report(const char* name, std::vector<double>& samples, double seconds)
+    {
+        std::sort(samples.begin(), samples.end());
+        auto pct = [&samples](double p) { return samples[static_cast<size_t>(p * static_cast<double>(samples.size() - 1))]; };
+        printf("%-6s %10.2f %10.2f %10.2f %10.2f %10.2f %12.0f\n", name, pct(0.50), pct(0.90), pct(0.99), pct(0.999),
+               samples.back(), static_cast<double>(samples.size()) / seconds);
+    }
+
+    /* Runs count + warmup round trips through send_recv and reports the timed ones in microseconds */
+    template <typename F>
+    void measure(const char* name, const Options& opt, F send_recv)
+    {
+        std::vector<double> samples;
+        samples.reserve(static_cast<size_t>(opt.count));
+        for (long i = 0; i < opt.warmup; i++)
+        {
+            send_recv();
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (long i = 0; i < opt.count; i++)
+        {
+            auto t0 = std::chrono::steady_clock::now();
+            send_recv();
+            auto t1 = std::chrono::steady_clock::now();
+            samples.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        report(name, samples, seconds);
+    }
+
+    int run_tcp(const Options& opt)
+    {
+        int listener = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t addr_len = sizeof(addr);
+        if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            listen(listener, 1) != 0 || getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &addr_len) != 0)
+        {
+            perror("tcp listen");
+            return 1;
+        }
+
+        pid_t peer = fork();
+        if (peer == 0)
+        {
+            pin(opt.cpu_peer);
+            int fd = accept(listener, nullptr, nullptr);
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            std::vector<uint8_t> buf(opt.size);
+            while (read_full(fd, buf.data(), buf.size()) && send(fd, buf.data(), buf.size(), 0) == static_cast<ssize_t>(buf.size()))
+            {
+            }
+            _exit(0);
+        }
+        close(listener);
+
+        pin(opt.cpu_client);
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+        {
+            perror("tcp connect");
+            kill(peer, SIGTERM);
+            return 1;
+        }
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        std::vector<uint8_t> buf(opt.size, 0xA5);
+        bool ok = true;
+        measure("tcp", opt, [&]() {
+            ok = ok && send(fd, buf.data(), buf.size(), 0) == static_cast<ssize_t>(buf.size()) && read_full(fd, buf.data(), buf.size());
+        });
+        close(fd);
+        waitpid(peer, nullptr, 0);
+        return ok ? 0 : 1;
+    }
+
+    int run_shm(const Options& opt)
+    {
+        /* An anonymous shared mapping inherited over fork costs the same per access as a named shm:// segment */
+        void* mem = mmap(nullptr, sizeof(SharedLink), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED)
+        {
+            perror("shm mmap");
+            return 1;
+        }
+        SharedLink* link = new (mem) SharedLink();
+        link->request.head = link->request.tail = link->request.waiting = 0;
+        link->reply.head = link->reply.tail = link->reply.waiting = 0;
+
+        pid_t peer = fork();
+        if (peer == 0)
+        {
+            pin(opt.cpu_peer);
+            std::vector<uint8_t> buf(SLOT_BYTES);
+            for (;;)
+            {
+                uint32_t length = ring_pop(link->request, buf.data());
+                if (length == 0)
+                {
+                    _exit(0);
+                }
+                ring_push(link->reply, buf.data(), length);
+            }
+        }
+
+        pin(opt.cpu_client);
+        std::vector<uint8_t> buf(opt.size, 0xA5);
+        uint32_t length = static_cast<uint32_t>(opt.size);
+        measure("shm", opt, [&]() {
+            ring_push(link->request, buf.data(), length);
+            ring_pop(link->reply, buf.data());
+        });
+        ring_push(link->request, buf.data(), 0);
+        waitpid(peer, nullptr, 0);
+        munmap(mem, sizeof(SharedLink));
+        return 0;
+    }
+
+    void usage(const char* prog)
+    {
+        fprintf(stderr,
+                "Usage: %s [-m tcp|shm|both] [-s bytes] [-n count] [-w warmup] [-c client_cpu,peer_cpu]\n"
+                "  Round trip latency of one transaction between two processes, in microseconds\n",
+                prog);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    int c;
+    while ((c = getopt(argc, argv, "m:s:n:w:c:h")) != -1)
+    {
+        switch (c)
+        {
+        case 'm': opt.mode = optarg; break;
+        case 's': opt.size = static_cast<size_t>(atol(optarg)); break;
+        case 'n': opt.count = atol(optarg); break;
+        case 'w': opt.warmup = atol(optarg); break;
+        case 'c':
+            if (sscanf(optarg, "%d,%d", &opt.cpu_client, &opt.cpu_peer) != 2)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (opt.size == 0 || opt.size > SLOT_BYTES || opt.count <= 0 || opt.warmup < 0 ||
+        (opt.mode != "tcp" && opt.mode != "shm" && opt.mode != "both"))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    printf("%ld round trips of %lu bytes\n", opt.count, static_cast<unsigned long>(opt.size));
+    printf("%-6s %10s %10s %10s %10s %10s %12s\n", "path", "p50 us", "p90 us", "p99 us", "p99.9 us", "max us", "trans/s");
+    int status = 0;
+    if (opt.mode != "shm")
+    {
+        status |= run_tcp(opt);
+    }
+    if (opt.mode != "tcp")
+    {
+        status |= run_shm(opt);
+    }
+    return status;
+}